@@ -0,0 +1,390 @@
+#include "PhysicsWindow.h"
+#include "Brush.h"
+#include "Snapshot.h"
+#include "Trace.h"
+#include <QEvent>
+#include <QResizeEvent>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QGraphicsSceneMouseEvent>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <math.h>
+#include <QThread>
+#include <QDebug>
+
+namespace{
+
+    // One line per counter and phase of counters, for m_countersOverlayItem.
+    QString CountersText(const TickCounters& counters){
+        if(!Counters::Enabled()){
+            return "Built without counters (qmake CONFIG+=counters)";
+        }
+        QString text = QString("tick %0").arg(counters.tick);
+        for(int i = 0; i < Counters::CounterCount; ++i){
+            text += QString("\n%0 %1").arg(Counters::Name(static_cast<Counters::Counter>(i))).arg(counters.counts[i]);
+        }
+        for(int i = 0; i < Counters::PhaseCount; ++i){
+            text += QString("\n%0 %1").arg(Counters::Name(static_cast<Counters::Phase>(i))).arg(counters.phaseMilliseconds[i], 0, 'f', 3);
+        }
+        return text;
+    }
+
+}
+
+PhysicsWindow::PhysicsWindow(QWidget* parent) :
+    QWidget(parent)
+  , m_engine(500, 500)
+  , m_simulation(m_engine)
+  , m_radiusSlider(Qt::Orientation::Horizontal)
+  , m_engineGraphicsItem(m_simulation)
+  , m_previewPixelItem(m_previewSpans, m_currentMaterial)
+  , m_leftMousePressed(false)
+  , m_rightMousePressed(false)
+  , m_shiftKeyPressed(false)
+  , m_radius(1)
+  , m_scale(1.0)
+  , m_currentMaterial(Mat::Material::EMPTY)
+{
+    setLayout(&m_mainVLayout);
+    m_mainVLayout.addWidget(&m_view);
+    m_view.setScene(&m_scene);
+    m_scene.installEventFilter(this);
+    m_view.setAlignment(Qt::AlignTop|Qt::AlignLeft);
+    m_view.setViewportUpdateMode(QGraphicsView::SmartViewportUpdate);
+    m_view.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_view.setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_engine.SetThreadCount(QThread::idealThreadCount());
+    connect(&m_updateTimer, &QTimer::timeout, this, &PhysicsWindow::UpdateView, Qt::DirectConnection);
+    m_updateTimer.start(16);
+
+    m_resizeTimer.setSingleShot(true);
+    m_resizeTimer.setInterval(100);
+    connect(&m_resizeTimer, &QTimer::timeout, this, &PhysicsWindow::ApplyResize, Qt::DirectConnection);
+
+    m_view.setSizeAdjustPolicy(QAbstractScrollArea::SizeAdjustPolicy::AdjustToContents);
+
+    SetScale(5.0);
+
+    QStringList materialList;
+    QMetaEnum materialMetaEnum = QMetaEnum::fromType<Mat::Material>();
+    for( int i = 0; i < materialMetaEnum.keyCount(); ++i ){
+        materialList.append(materialMetaEnum.key(i));
+    }
+    m_materialComboBox.addItems(materialList);
+    m_mainVLayout.addWidget(&m_materialComboBox);
+    QWidget* sliderWidget = new QWidget;
+    QHBoxLayout* sliderHLayout = new QHBoxLayout;
+    sliderWidget->setLayout(sliderHLayout);
+    m_mainVLayout.addWidget(sliderWidget);
+    sliderHLayout->addWidget(&m_radiusValueLabel);
+    sliderHLayout->addWidget(&m_radiusSlider);
+    m_mainVLayout.addWidget(sliderWidget);
+    m_radiusSlider.setRange(1, 200);
+
+    QWidget* schedulerWidget = new QWidget;
+    QHBoxLayout* schedulerHLayout = new QHBoxLayout;
+    schedulerWidget->setLayout(schedulerHLayout);
+    // In TickScheduler::CatchUp order.
+    m_catchUpComboBox.addItems({ "Drop ticks", "Substep", "Shrink region" });
+    m_catchUpComboBox.setCurrentIndex(static_cast<int>(TickScheduler::CatchUp::SUBSTEP));
+    schedulerHLayout->addWidget(&m_catchUpComboBox);
+    schedulerHLayout->addWidget(&m_statisticsLabel, 1);
+    m_mainVLayout.addWidget(schedulerWidget);
+
+    connect(&m_materialComboBox, &QComboBox::currentTextChanged, this, &PhysicsWindow::MaterialComboBoxValueChanged, Qt::DirectConnection);
+    connect(&m_radiusSlider,     &QSlider::valueChanged,         this, &PhysicsWindow::RadiusSliderValueChanged,     Qt::DirectConnection);
+    connect(&m_catchUpComboBox,  QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PhysicsWindow::CatchUpComboBoxIndexChanged, Qt::DirectConnection);
+
+    m_radiusSlider.setValue(m_radius);
+    RadiusSliderValueChanged(m_radius);
+
+    QColor alphaMaterialColor(QColor::fromRgba(Mat::TraitsOf(m_currentMaterial).color));
+    alphaMaterialColor.setAlpha(128);
+    m_lineOverlayItem.setPen(QPen(alphaMaterialColor, m_radius));
+
+    m_lineOverlayItem.hide();
+
+    // Drawn at screen size in the top left corner whatever m_scale is.
+    m_countersOverlayItem.setFlag(QGraphicsItem::ItemIgnoresTransformations);
+    m_countersOverlayItem.setBrush(Qt::white);
+    m_countersOverlayItem.setZValue(1.0);
+    m_countersOverlayItem.hide();
+
+    m_scene.addItem(&m_engineGraphicsItem);
+    m_scene.addItem(&m_lineOverlayItem);
+    m_scene.addItem(&m_previewPixelItem);
+    m_scene.addItem(&m_countersOverlayItem);
+
+    m_view.setMouseTracking(true);
+
+    Trace::SetThreadName("UI");
+
+    m_simulation.Start();
+}
+
+void PhysicsWindow::CircleAt( QVector<Span>& spans ){
+    spans.clear();
+    if(m_lastMousePosition.x() > 0 && m_lastMousePosition.y() > 0){
+        Brush::Circle(floor(m_lastMousePosition.x()), floor(m_lastMousePosition.y()), m_radius, spans);
+    }
+}
+
+void PhysicsWindow::LineAt(){
+    m_brushSpans.clear();
+    Brush::Line(m_lineOverlayLine.p1(), m_lineOverlayLine.p2(), m_radius, m_brushSpans);
+    FillBrush();
+}
+
+void PhysicsWindow::FillBrush(){
+    PPE_TRACE_ZONE("Brush");
+    const QVector<Span> spans = m_brushSpans;
+    const Mat::Material material = m_currentMaterial;
+    m_simulation.Post([spans, material](Engine& engine){
+        engine.FillSpans(spans, material);
+    });
+}
+
+void PhysicsWindow::IgniteBrush(){
+    QVector<Span> spans;
+    CircleAt(spans);
+    m_simulation.Post([spans](Engine& engine){
+        engine.IgniteSpans(spans);
+    });
+}
+
+bool PhysicsWindow::eventFilter(QObject* target, QEvent* event)
+{
+    PPE_TRACE_ZONE("Input");
+
+    auto PlaceCircle = [this](){
+        CircleAt(m_brushSpans);
+        FillBrush();
+    };
+
+    auto PreviewPixelsAt = [this](){
+        CircleAt(m_previewSpans);
+        m_previewPixelItem.update();
+    };
+
+    if (target == &m_scene){
+
+        if(event->type() == QEvent::GraphicsSceneMouseMove){
+            const QGraphicsSceneMouseEvent* const mouseEvent = static_cast<const QGraphicsSceneMouseEvent*>(event);
+            m_lastMousePosition = mouseEvent->scenePos();
+            m_simulation.SetFocus(m_lastMousePosition.toPoint());
+            PreviewPixelsAt();
+        }
+
+        if (event->type() == QEvent::GraphicsSceneMousePress){
+            const QGraphicsSceneMouseEvent* const mouseEvent = static_cast<const QGraphicsSceneMouseEvent*>(event);
+            if( (mouseEvent->buttons() & Qt::LeftButton) == Qt::LeftButton && !m_leftMousePressed ){
+                m_leftMousePressed  = true;
+                m_lastMousePosition = mouseEvent->scenePos();
+            }
+            if( (mouseEvent->buttons() & Qt::RightButton) == Qt::RightButton && !m_rightMousePressed ){
+                m_rightMousePressed  = true;
+                m_lastMousePosition = mouseEvent->scenePos();
+                m_lineOverlayLine.setP1(m_lastMousePosition);
+                m_lineOverlayItem.show();
+            }
+        }
+        else if(event->type() == QEvent::GraphicsSceneMouseRelease){
+            const QGraphicsSceneMouseEvent* const mouseEvent = static_cast<const QGraphicsSceneMouseEvent*>(event);
+            if((mouseEvent->button() & Qt::LeftButton) == Qt::LeftButton){
+                m_leftMousePressed  = false;
+                m_lastMousePosition = QPointF(-1, -1);
+            }else if((mouseEvent->button() & Qt::RightButton) == Qt::RightButton){
+                m_rightMousePressed = false;
+                LineAt();
+                m_lineOverlayLine.setPoints(QPointF(-1,-1), QPointF(-2,-2));
+                m_lineOverlayItem.hide();
+                m_lineOverlayItem.setLine(m_lineOverlayLine);
+            }
+        }else if(event->type() == QEvent::GraphicsSceneMouseMove && ( m_leftMousePressed || m_rightMousePressed ) ){
+            if(m_rightMousePressed){
+                m_lineOverlayLine.setP2(m_lastMousePosition);
+                m_lineOverlayItem.setLine(m_lineOverlayLine);
+            }
+            if(m_shiftKeyPressed){
+                LineAt();
+            }
+        }else if(event->type() == QEvent::GraphicsSceneDragLeave){
+            m_leftMousePressed  = false;
+        }else if(event->type() == QEvent::GraphicsSceneDragEnter){
+            const QGraphicsSceneMouseEvent* const mouseEvent = static_cast<const QGraphicsSceneMouseEvent*>(event);
+            m_leftMousePressed  = ( mouseEvent->buttons() & Qt::LeftButton );
+            m_rightMousePressed = ( mouseEvent->buttons() & Qt::RightButton );
+        }
+    }
+
+    if(m_leftMousePressed){
+        PlaceCircle();
+        m_previewPixelItem.hide();
+    }else{
+        m_previewPixelItem.show();
+    }
+
+    m_previewPixelItem.setVisible(m_view.underMouse() && !m_leftMousePressed);
+
+    return QWidget::eventFilter(target, event);
+}
+
+void PhysicsWindow::resizeEvent(QResizeEvent* resizeEvent){
+    m_resizeTimer.start();
+    QWidget::resizeEvent(resizeEvent);
+}
+
+// Resizes the world to fit the view, keeping its cells on the bottom edge.
+void PhysicsWindow::ApplyResize(){
+
+    int scaledWidth  = ( m_view.contentsRect().width()  / m_scale ) + 1;
+    int scaledheight = ( m_view.contentsRect().height() / m_scale ) + 1;
+
+    m_scene.setSceneRect(0, 0, scaledWidth, scaledheight);
+
+    // These widths and heights are needed for the QGraphicsItem::boundingRect overrides.
+    m_engineGraphicsItem.width  = scaledWidth;
+    m_engineGraphicsItem.height = scaledheight;
+
+    m_previewPixelItem.width  = scaledWidth;
+    m_previewPixelItem.height = scaledheight;
+
+    m_simulation.Post([scaledWidth, scaledheight](Engine& engine){
+        engine.ResizeKeepingCells(scaledWidth, scaledheight, Qt::AlignLeft | Qt::AlignBottom);
+    });
+}
+
+void PhysicsWindow::keyPressEvent(QKeyEvent* keyEvent){
+    if(keyEvent->matches(QKeySequence::Save)){
+        SaveSnapshot();
+        return;
+    }
+    if(keyEvent->matches(QKeySequence::Open)){
+        LoadSnapshot();
+        return;
+    }
+    if(keyEvent->key() == Qt::Key_F3){
+        ToggleCountersOverlay();
+        return;
+    }
+    if(keyEvent->key() == Qt::Key_F4){
+        ToggleTrace();
+        return;
+    }
+    if(keyEvent->key() == Qt::Key_F){
+        IgniteBrush();
+        return;
+    }
+    if(m_rightMousePressed && ( keyEvent->modifiers() & Qt::ShiftModifier )){
+        m_shiftKeyPressed = true;
+        LineAt();
+    }
+}
+
+void PhysicsWindow::keyReleaseEvent(QKeyEvent* keyEvent){
+    if( (keyEvent->modifiers() & Qt::ShiftModifier ) == 0){
+        m_shiftKeyPressed = false;
+    }
+}
+
+void PhysicsWindow::MaterialComboBoxValueChanged(const QString& newMaterialString){
+    QMetaEnum materialMetaEnum = QMetaEnum::fromType<Mat::Material>();
+    m_currentMaterial = static_cast<Mat::Material>(materialMetaEnum.keyToValue(newMaterialString.toStdString().c_str()));
+
+    QColor alphaMaterialColor(QColor::fromRgba(Mat::TraitsOf(m_currentMaterial).color));
+    alphaMaterialColor.setAlpha(128);
+    m_lineOverlayItem.setPen(QPen(alphaMaterialColor, m_radius));
+}
+
+void PhysicsWindow::RadiusSliderValueChanged(int value){
+    m_radius = value;
+    m_radiusValueLabel.setText(QString("Radius: %0").arg(QString::number(m_radius)));
+    m_lineOverlayItem.setPen(QPen(m_lineOverlayItem.pen().color(), m_radius));
+}
+
+void PhysicsWindow::CatchUpComboBoxIndexChanged(int index){
+    m_simulation.SetCatchUp(static_cast<TickScheduler::CatchUp>(index));
+}
+
+void PhysicsWindow::SetScale(double scale){
+    m_scale = scale;
+    m_view.scale(m_scale, m_scale);
+    m_view.fitInView(m_scene.sceneRect());
+    ApplyResize();
+}
+
+// Connected to the updateTimer::timeout. Shows the newest frame and the scheduler's measurements.
+void PhysicsWindow::UpdateView(){
+    PPE_TRACE_ZONE("UpdateView");
+    const Frame* frame = m_engineGraphicsItem.Refresh();
+    if(frame != nullptr && m_countersOverlayItem.isVisible()){
+        m_countersOverlayItem.setText(CountersText(frame->counters));
+    }
+
+    const TickScheduler::Statistics statistics = m_simulation.Statistics();
+    m_statisticsLabel.setText(QString("Tick %0 ms  Backlog %1  Dropped %2  Region %3%")
+                              .arg(statistics.tickMilliseconds, 0, 'f', 1)
+                              .arg(statistics.backlog, 0, 'f', 1)
+                              .arg(statistics.droppedTicks)
+                              .arg(qRound(statistics.regionScale * 100.0)));
+}
+
+// Shows or hides the engine counters over the world.
+void PhysicsWindow::ToggleCountersOverlay(){
+    m_countersOverlayItem.setVisible(!m_countersOverlayItem.isVisible());
+    if(!Counters::Enabled()){
+        m_countersOverlayItem.setText(CountersText(TickCounters()));
+    }
+}
+
+// Starts recording a Trace, or stops it and asks for a file to save it to.
+void PhysicsWindow::ToggleTrace(){
+    if(!Trace::Enabled()){
+        QMessageBox::information(this, "Trace", "Built without trace zones (qmake CONFIG+=trace)");
+        return;
+    }
+    if(!Trace::IsRecording()){
+        Trace::Start();
+        return;
+    }
+
+    Trace::Stop();
+    const QString path = QFileDialog::getSaveFileName(this, "Save trace", QString(), "Chrome traces (*.json)");
+    if(path.isEmpty()) return;
+
+    QString error;
+    if(!Trace::Save(path, &error)){
+        QMessageBox::warning(this, "Save trace", error);
+    }
+}
+
+// Asks for a file and saves the world to it as a Snapshot.
+void PhysicsWindow::SaveSnapshot(){
+    const QString path = QFileDialog::getSaveFileName(this, "Save world", QString(), "Snapshots (*.snapshot)");
+    if(path.isEmpty()) return;
+
+    QString error;
+    bool saved = false;
+    m_simulation.Invoke([&](Engine& engine){
+        saved = Snapshot::Save(path, engine, Snapshot::Compression::RLE, &error);
+    });
+    if(!saved){
+        QMessageBox::warning(this, "Save world", error);
+    }
+}
+
+// Asks for a Snapshot file and replaces the world with it.
+void PhysicsWindow::LoadSnapshot(){
+    const QString path = QFileDialog::getOpenFileName(this, "Load world", QString(), "Snapshots (*.snapshot)");
+    if(path.isEmpty()) return;
+
+    QString error;
+    bool loaded = false;
+    m_simulation.Invoke([&](Engine& engine){
+        loaded = Snapshot::Load(path, engine, &error);
+    });
+    if(!loaded){
+        QMessageBox::warning(this, "Load world", error);
+    }
+}
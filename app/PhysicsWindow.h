@@ -0,0 +1,119 @@
+#ifndef PHYSICSWINDOW_H
+#define PHYSICSWINDOW_H
+
+#include "Engine.h"
+#include "SimulationThread.h"
+#include "QGraphicsEngineItem.h"
+#include "QGraphicsPixelItem.h"
+#include <QWidget>
+#include <QGraphicsScene>
+#include <QVBoxLayout>
+#include <QComboBox>
+#include <QGraphicsView>
+#include <QSlider>
+#include <QLabel>
+#include <QTimer>
+
+class QEvent;
+class QResizeEvent;
+class QKeyEvent;
+
+class PhysicsWindow : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PhysicsWindow(QWidget* parent = nullptr);
+
+protected:
+
+    bool eventFilter(QObject* target, QEvent* event);
+
+    void resizeEvent(QResizeEvent* resizeEvent) override;
+
+    void keyPressEvent(QKeyEvent* keyEvent) override;
+
+    void keyReleaseEvent(QKeyEvent* keyEvent) override;
+
+    void MaterialComboBoxValueChanged(const QString& newMaterialString);
+
+    void RadiusSliderValueChanged(int value);
+
+    void CatchUpComboBoxIndexChanged(int index);
+
+    void SetScale(double scale);
+
+    // Resizes the world to fit the view, keeping its cells on the bottom edge. Window resizes arrive in bursts while
+    // an edge is dragged, so resizeEvent only restarts m_resizeTimer and this runs once the burst is over.
+    void ApplyResize();
+
+    // Connected to the updateTimer::timeout. Shows the newest frame the simulation published and the scheduler's
+    // measurements; the simulation itself ticks on m_simulation's thread at its own rate.
+    void UpdateView();
+
+    // Asks for a file and saves the world to it as a Snapshot. Bound to the platform's Save shortcut.
+    void SaveSnapshot();
+
+    // Asks for a Snapshot file and replaces the world with it. Bound to the platform's Open shortcut.
+    void LoadSnapshot();
+
+    // Shows or hides m_countersOverlayItem. Bound to F3.
+    void ToggleCountersOverlay();
+
+    // Starts recording a Trace, or stops it and asks for a file to save it to. Bound to F4.
+    void ToggleTrace();
+
+    // Helper functions for drawing. Both rasterize the brush into spans.
+    // Replaces spans with the circle of m_radius under the mouse, or clears it when the mouse is outside the scene.
+    void CircleAt( QVector<Span>& spans );
+
+    // Fills the line overlay stroked m_radius wide with the current material.
+    void LineAt();
+
+    // Queues filling m_brushSpans with the current material on the simulation thread.
+    void FillBrush();
+
+    // Queues setting alight whatever will burn in the circle of m_radius under the mouse. Bound to F.
+    void IgniteBrush();
+
+protected:
+
+    // Core engine. Once m_simulation runs, its world is only touched through m_simulation.Post and Invoke.
+    Engine m_engine;
+    SimulationThread m_simulation;
+    QTimer m_updateTimer;
+    QTimer m_resizeTimer;
+
+    // Widgets and layouts
+    QVBoxLayout    m_mainVLayout;
+    QGraphicsScene m_scene;
+    QGraphicsView  m_view;
+    QComboBox      m_materialComboBox;
+    QSlider        m_radiusSlider;
+    QLabel         m_radiusValueLabel;
+    QComboBox      m_catchUpComboBox;
+    QLabel         m_statisticsLabel;
+
+    // Drawing
+    QGraphicsEngineItem m_engineGraphicsItem;
+
+    QGraphicsLineItem   m_lineOverlayItem;
+    QLineF              m_lineOverlayLine;
+
+    QGraphicsSimpleTextItem m_countersOverlayItem; // Engine counters of the frame shown, see Counters.h
+
+    QGraphicsPixelItem  m_previewPixelItem;
+    QVector<Span>       m_previewSpans;
+    QVector<Span>       m_brushSpans; // Reused by every brush stroke
+
+    // States
+    bool    m_leftMousePressed;
+    bool    m_rightMousePressed;
+    bool    m_shiftKeyPressed;
+    QPointF m_lastMousePosition;
+    int     m_radius;
+    double  m_scale;
+    Mat::Material m_currentMaterial; // Drawn by the brush, picked in m_materialComboBox
+
+};
+
+#endif // PHYSICSWINDOW_H
@@ -0,0 +1,48 @@
+#include "QGraphicsEngineItem.h"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QWidget>
+#include "SimulationThread.h"
+#include "Trace.h"
+
+QGraphicsEngineItem::QGraphicsEngineItem(SimulationThread& simulationIn) :
+    QGraphicsItem()
+  , simulation(simulationIn)
+  , width(100)
+  , height(100)
+{
+    setCacheMode(QGraphicsItem::NoCache);
+    // Fills option->exposedRect in paint so partial updates blit partially too.
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+void QGraphicsEngineItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget*)
+{
+    PPE_TRACE_ZONE("Paint");
+    // Only blit the part the view asked for, such as what another window uncovered.
+    const QRect exposed = option->exposedRect.toAlignedRect().intersected(m_framebuffer.rect());
+    painter->drawImage(exposed.topLeft(), m_framebuffer, exposed);
+}
+
+// Switches to the newest frame, if one was published since the last call, and schedules a repaint of just the
+// regions it changed. A frame of another size repaints everything.
+const Frame* QGraphicsEngineItem::Refresh(){
+    const Frame* frame = simulation.TakeFrame();
+    if(frame == nullptr){
+        return nullptr;
+    }
+    const bool resized = m_framebuffer.width() != frame->width || m_framebuffer.height() != frame->height;
+
+    // Every material color is opaque, so the alpha channel is skipped and the blit needs no blending.
+    // The frame is left alone by the simulation until the next TakeFrame, which replaces this image first.
+    m_framebuffer = QImage(reinterpret_cast<const uchar*>(frame->pixels.data()), frame->width, frame->height,
+                           frame->width * static_cast<int>(sizeof(quint32)), QImage::Format_RGB32);
+    if(resized){
+        update();
+    }else{
+        for(const QRect& rect : frame->changedRects){
+            update(QRectF(rect));
+        }
+    }
+    return frame;
+}
@@ -0,0 +1,46 @@
+#ifndef QGRAPHICSENGINEITEM_H
+#define QGRAPHICSENGINEITEM_H
+
+#include <QObject>
+#include <QGraphicsItem>
+#include <QImage>
+#include <QVector>
+#include <QRectF>
+
+class QPainter;
+class QStyleOptionGraphicsItem;
+class QWidget;
+class SimulationThread;
+struct Frame;
+
+// Shows the world as a single image: the newest Frame the simulation thread published, wrapped without a copy.
+class QGraphicsEngineItem : public QGraphicsItem{
+
+public:
+
+    explicit QGraphicsEngineItem(SimulationThread& simulation);
+
+    QRectF boundingRect() const override{
+        return QRectF(0, 0, width, height);
+    }
+
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+    // Switches to the newest frame, if one was published since the last call, and schedules a repaint of the
+    // regions it changed.
+    // Returns that frame, valid until the next call, or nullptr if nothing new was published.
+    const Frame* Refresh();
+
+public:
+
+    SimulationThread& simulation;
+    int width;
+    int height;
+
+protected:
+
+    QImage m_framebuffer; // Borrows the pixels of the frame taken last
+};
+
+
+#endif // QGRAPHICSENGINEITEM_H
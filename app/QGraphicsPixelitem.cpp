@@ -0,0 +1,30 @@
+#include "QGraphicsPixelItem.h"
+#include <QPainter>
+#include <QColor>
+#include <QStyleOptionGraphicsItem>
+
+QGraphicsPixelItem::QGraphicsPixelItem(QVector<Span>& spansIn, Mat::Material& materialIn) :
+    QGraphicsItem()
+  , spans(spansIn)
+  , width(100)
+  , height(100)
+  , currentMaterial(materialIn)
+{
+    setCacheMode(QGraphicsItem::NoCache);
+}
+
+void QGraphicsPixelItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*, QWidget*)
+{
+    painter->save();
+
+    QColor alphaMaterialColor(QColor::fromRgba(Mat::TraitsOf(currentMaterial).color));
+    alphaMaterialColor.setAlpha(128);
+    painter->setPen(QPen(alphaMaterialColor));
+
+    // A square capped line covers the same cells as a point on each one.
+    for(const Span& span : spans) {
+        painter->drawLine(span.left, span.y, span.right, span.y);
+    }
+
+    painter->restore();
+}
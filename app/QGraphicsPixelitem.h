@@ -6,6 +6,7 @@
 #include <QVector>
 #include <QRectF>
 #include "Elements.h"
+#include "Span.h"
 
 class QPainter;
 class QStyleOptionGraphicsItem;
@@ -16,7 +17,7 @@ class QGraphicsPixelItem : public QGraphicsItem{
 
 public:
 
-    explicit QGraphicsPixelItem(QVector<QPoint>& pixelsIn, Mat::Material& engineMaterial);
+    explicit QGraphicsPixelItem(QVector<Span>& spansIn, Mat::Material& materialIn);
 
     QRectF boundingRect() const override{
         return QRectF(0, 0, width, height);
@@ -26,7 +27,7 @@ public:
 
 public:
 
-    QVector<QPoint>& pixels;
+    QVector<Span>& spans;
     int width;
     int height;
     Mat::Material& currentMaterial;
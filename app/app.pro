@@ -0,0 +1,30 @@
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17
+TARGET  = PixelPhysicsEngine
+QMAKE_CXXFLAGS += -Wall -Wextra -pedantic -Wshadow
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+include(../core/core.pri)
+
+SOURCES += \
+    PhysicsWindow.cpp \
+    QGraphicsEngineItem.cpp \
+    QGraphicsPixelItem.cpp \
+    main.cpp \
+    MainWindow.cpp
+
+HEADERS += \
+    MainWindow.h \
+    PhysicsWindow.h \
+    QGraphicsEngineItem.h \
+    QGraphicsPixelItem.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,148 @@
+#include "BenchmarkScenarios.h"
+#include "Engine.h"
+#include "Elements.h"
+#include <QBitArray>
+#include <QRect>
+#include <algorithm>
+#include <random>
+
+namespace{
+
+    // Fills the part of the rect that lies inside the world. Cells are skipped with probability holeChance.
+    void FillRect(Engine& engine, std::mt19937& random, Mat::Material material, int x, int y, int width, int height, double holeChance = 0.0){
+        const QRect rect = QRect(x, y, width, height).intersected(QRect(0, 0, engine.Width(), engine.Height()));
+        if(holeChance <= 0.0){
+            engine.FillRect(rect, material);
+            return;
+        }
+        std::bernoulli_distribution hole(holeChance);
+        QBitArray mask(rect.isEmpty() ? 0 : rect.width() * rect.height());
+        for(int i = 0; i < mask.size(); ++i){
+            mask.setBit(i, !hole(random));
+        }
+        engine.FillMask(rect, mask, material);
+    }
+
+    // A sand heap resting on a ledge, its open side collapsing off the end of the ledge.
+    void Avalanche(Engine& engine, std::mt19937& random, int size){
+        FillRect(engine, random, Mat::Material::WOOD, 0, size / 2, size * 5 / 8, 2);
+        FillRect(engine, random, Mat::Material::SAND, 0, size / 8, size / 2, size / 2 - size / 8, 0.1);
+    }
+
+    // The top half is a full tank of water sitting on a floor with a narrow gap in the middle.
+    // The worst case for long range liquid flow: every surface cell keeps searching along its row.
+    void WaterDrain(Engine& engine, std::mt19937& random, int size){
+        const int gap = std::max(2, size / 64);
+        FillRect(engine, random, Mat::Material::WOOD,  0, size / 2, ( size - gap ) / 2, 2);
+        FillRect(engine, random, Mat::Material::WOOD,  ( size + gap ) / 2, size / 2, size, 2);
+        FillRect(engine, random, Mat::Material::WATER, 0, 0, size, size / 2);
+    }
+
+    // A band of sand dropped into a pool, sinking through the water by density.
+    void SandIntoWater(Engine& engine, std::mt19937& random, int size){
+        FillRect(engine, random, Mat::Material::WATER, 0, size / 2, size, size / 2);
+        FillRect(engine, random, Mat::Material::SAND,  size / 4, 0, size / 2, size / 8, 0.1);
+    }
+
+    // Shelves and posts of wood with random openings, with sand and water poured in from the top.
+    void WoodMaze(Engine& engine, std::mt19937& random, int size){
+        const int spacing = std::max(16, size / 16);
+        std::bernoulli_distribution opening(0.25);
+        for(int y = spacing * 2; y < size; y += spacing){
+            for(int x = 0; x < size; x += spacing){
+                if(!opening(random)){
+                    FillRect(engine, random, Mat::Material::WOOD, x, y, spacing, 1);
+                }
+                if(opening(random)){
+                    FillRect(engine, random, Mat::Material::WOOD, x, y - spacing, 1, spacing);
+                }
+            }
+        }
+        FillRect(engine, random, Mat::Material::SAND,  0,        0, size / 2, spacing, 0.1);
+        FillRect(engine, random, Mat::Material::WATER, size / 2, 0, size / 2, spacing);
+    }
+
+    // A tall column of sand on the floor collapsing into a heap. Also what --compare-kernels measures piles on.
+    void SandPile(Engine& engine, std::mt19937& random, int size){
+        FillRect(engine, random, Mat::Material::SAND, size * 7 / 16, size / 4, size / 8, size * 3 / 4);
+    }
+
+    // A scattered layer of sand near the top of an empty world, falling the whole height of it onto the floor.
+    // Falling cells speed up, so this measures how little a long drop costs per row fallen.
+    void SandDrop(Engine& engine, std::mt19937& random, int size){
+        FillRect(engine, random, Mat::Material::SAND, 0, size / 16, size, size / 16, 0.5);
+    }
+
+    // Full-width layers of sand under water. Everything settles on the first tick, so this measures idle cost.
+    void Idle(Engine& engine, std::mt19937& random, int size){
+        FillRect(engine, random, Mat::Material::SAND,  0, size * 3 / 4, size, size / 4);
+        FillRect(engine, random, Mat::Material::WATER, 0, size / 2,     size, size / 4);
+    }
+
+    // The idle layers with the bottom of the sand heated, so the only work is conducting heat through the whole world.
+    void HotPlate(Engine& engine, std::mt19937& random, int size){
+        Idle(engine, random, size);
+        engine.SetTemperature(QRect(0, size - size / 16, size, size / 16), 400.0f);
+    }
+
+    // Wooden trees of random heights on a wooden floor, set alight along the left edge. The fire front creeps across
+    // the forest while the rest of it stays idle, so this measures what burning costs per cell on fire.
+    void ForestFire(Engine& engine, std::mt19937& random, int size){
+        const int spacing = std::max(8, size / 32);
+        const int floor   = size - std::max(2, size / 64);
+        std::uniform_int_distribution<int> height(spacing, spacing * 4);
+        FillRect(engine, random, Mat::Material::WOOD, 0, floor, size, size - floor);
+        for(int x = 0; x < size; x += spacing){
+            const int top = floor - height(random);
+            FillRect(engine, random, Mat::Material::WOOD, x + spacing / 2 - 1, top, 2, floor - top);
+            FillRect(engine, random, Mat::Material::WOOD, x + 1, top - spacing / 2, spacing - 2, spacing / 2);
+        }
+        engine.Ignite(QRect(0, 0, spacing, size));
+    }
+
+    // A lake on a bed of sand heated far past boiling, with a sheet of ice floating above it. Steam boils off the
+    // bottom of the lake, rises, melts the ice and condenses as it cools, so phase changes happen all over the world.
+    void BoilingLake(Engine& engine, std::mt19937& random, int size){
+        FillRect(engine, random, Mat::Material::SAND,  0, size * 7 / 8, size, size / 8);
+        FillRect(engine, random, Mat::Material::WATER, 0, size / 2,     size, size * 3 / 8);
+        FillRect(engine, random, Mat::Material::ICE,   size / 4, size / 8, size / 2, std::max(2, size / 64));
+        engine.SetTemperature(QRect(0, size * 7 / 8, size, size / 8), 1000.0f);
+    }
+
+}
+
+// Names accepted by Build, in the order the suite runs them.
+QStringList BenchmarkScenarios::Names(){
+    return QStringList() << "avalanche" << "water_drain" << "sand_into_water" << "wood_maze" << "sand_pile" << "sand_drop" << "idle" << "hot_plate" << "forest_fire" << "boiling_lake";
+}
+
+// Resizes engine to size x size and fills it with the named scenario. Returns false for an unknown name.
+bool BenchmarkScenarios::Build(const QString& name, int size, quint32 seed, Engine& engine){
+    std::mt19937 random(seed);
+    engine.ResizeTiles(size, size);
+
+    if(name == "avalanche"){
+        Avalanche(engine, random, size);
+    }else if(name == "water_drain"){
+        WaterDrain(engine, random, size);
+    }else if(name == "sand_into_water"){
+        SandIntoWater(engine, random, size);
+    }else if(name == "wood_maze"){
+        WoodMaze(engine, random, size);
+    }else if(name == "sand_pile"){
+        SandPile(engine, random, size);
+    }else if(name == "sand_drop"){
+        SandDrop(engine, random, size);
+    }else if(name == "idle"){
+        Idle(engine, random, size);
+    }else if(name == "hot_plate"){
+        HotPlate(engine, random, size);
+    }else if(name == "forest_fire"){
+        ForestFire(engine, random, size);
+    }else if(name == "boiling_lake"){
+        BoilingLake(engine, random, size);
+    }else{
+        return false;
+    }
+    return true;
+}
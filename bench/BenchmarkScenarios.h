@@ -0,0 +1,21 @@
+#ifndef BENCHMARKSCENARIOS_H
+#define BENCHMARKSCENARIOS_H
+
+#include <QString>
+#include <QStringList>
+
+class Engine;
+
+// Procedurally generated worlds for the benchmark suite.
+// The same name, size and seed always produce the same world.
+namespace BenchmarkScenarios{
+
+    // Names accepted by Build, in the order the suite runs them.
+    QStringList Names();
+
+    // Resizes engine to size x size and fills it with the named scenario. Returns false for an unknown name.
+    bool Build(const QString& name, int size, quint32 seed, Engine& engine);
+
+}
+
+#endif // BENCHMARKSCENARIOS_H
@@ -0,0 +1,17 @@
+QT       = core
+
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+TARGET   = PixelPhysicsBench
+QMAKE_CXXFLAGS += -Wall -Wextra -pedantic -Wshadow
+
+include(../core/core.pri)
+
+SOURCES += \
+    BenchmarkScenarios.cpp \
+    main.cpp
+
+HEADERS += \
+    BenchmarkScenarios.h
+
+win32: LIBS += -lpsapi
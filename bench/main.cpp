@@ -0,0 +1,763 @@
+#include "BenchmarkScenarios.h"
+#include "Engine.h"
+#include "Elements.h"
+#include "Recording.h"
+#include "Snapshot.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTextStream>
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace{
+
+    // Peak resident set size of this process in KiB, or -1 if the platform will not say.
+    qint64 PeakResidentKiB(){
+#if defined(Q_OS_WIN)
+        PROCESS_MEMORY_COUNTERS counters;
+        if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))){
+            return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+        }
+        return -1;
+#else
+        rusage usage;
+        if(getrusage(RUSAGE_SELF, &usage) != 0){
+            return -1;
+        }
+#if defined(Q_OS_MACOS)
+        return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+        return usage.ru_maxrss;        // KiB everywhere else
+#endif
+#endif
+    }
+
+    // Larger worlds get fewer ticks so every case finishes in comparable time.
+    int DefaultTicks(int size){
+        return std::max(10, 200 * 256 / size);
+    }
+
+    double Percentile(const std::vector<qint64>& sortedNanoseconds, double fraction){
+        const size_t index = static_cast<size_t>(std::ceil(fraction * sortedNanoseconds.size())) - 1;
+        return sortedNanoseconds[std::min(index, sortedNanoseconds.size() - 1)] / 1e6;
+    }
+
+    // Builds one scenario, runs it and measures every tick after the warmup.
+    QJsonObject RunCase(const QString& scenario, int size, quint32 seed, int threads, bool rowKernels, int warmupTicks, int ticks){
+        Engine engine(0, 0);
+        engine.SetThreadCount(threads);
+        engine.SetRowKernels(rowKernels);
+        engine.SetSeed(seed);
+        BenchmarkScenarios::Build(scenario, size, seed, engine);
+
+        engine.Step(warmupTicks);
+
+        std::vector<qint64> tickNanoseconds;
+        tickNanoseconds.reserve(ticks);
+        qint64 updatedCells     = 0;
+        qint64 skippedUpdates   = 0;
+        qint64 totalNanoseconds = 0;
+        QElapsedTimer timer;
+        for(int i = 0; i < ticks; ++i){
+            timer.start();
+            engine.Step();
+            const qint64 elapsed = timer.nsecsElapsed();
+            tickNanoseconds.push_back(elapsed);
+            totalNanoseconds += elapsed;
+            updatedCells     += engine.ActiveCellCount();
+            skippedUpdates   += engine.SkippedUpdateCount();
+        }
+        std::sort(tickNanoseconds.begin(), tickNanoseconds.end());
+
+        QJsonObject result;
+        result["scenario"]                 = scenario;
+        result["size"]                     = size;
+        result["seed"]                     = static_cast<qint64>(seed);
+        result["threads"]                  = engine.ThreadCount();
+        result["kernels"]                  = rowKernels ? "row" : "cell";
+        result["warmup_ticks"]             = warmupTicks;
+        result["ticks"]                    = ticks;
+        result["median_tick_ms"]           = Percentile(tickNanoseconds, 0.5);
+        result["p99_tick_ms"]              = Percentile(tickNanoseconds, 0.99);
+        result["mean_tick_ms"]             = totalNanoseconds / 1e6 / ticks;
+        result["cells_updated_per_sec"]    = totalNanoseconds > 0 ? updatedCells / ( totalNanoseconds / 1e9 ) : 0.0;
+        result["skipped_updates_per_tick"] = static_cast<double>(skippedUpdates) / ticks;
+        result["peak_rss_kib"]             = PeakResidentKiB();
+        return result;
+    }
+
+    // Shape of the settled powder in a world.
+    struct PileShape{
+        double cells     = 0;
+        double baseWidth = 0; // Columns holding any powder
+        double maxHeight = 0; // Tallest column, counted from the floor
+        double meanSlope = 0; // Mean height difference between neighbouring columns that both hold powder
+    };
+
+    PileShape MeasurePile(Engine& engine){
+        CellGrid& cells = engine.Cells();
+        QVector<int> heights(cells.Width(), 0);
+        PileShape shape;
+        for(int y = cells.Height() - 1; y >= 0; --y){
+            for(int x = 0; x < cells.Width(); ++x){
+                if(Mat::UsesRowKernel(static_cast<Mat::Material>(cells.material[cells.Index(x, y)]))){
+                    heights[x] = cells.Height() - y;
+                    shape.cells += 1;
+                }
+            }
+        }
+
+        int slopes = 0;
+        for(int x = 0; x < heights.size(); ++x){
+            if(heights[x] == 0) continue;
+            shape.baseWidth += 1;
+            shape.maxHeight  = std::max(shape.maxHeight, static_cast<double>(heights[x]));
+            if(x + 1 < heights.size() && heights[x + 1] > 0){
+                shape.meanSlope += std::abs(heights[x + 1] - heights[x]);
+                ++slopes;
+            }
+        }
+        shape.meanSlope = slopes > 0 ? shape.meanSlope / slopes : 0.0;
+        return shape;
+    }
+
+    // Lets the scenario settle with the given kernels, once per seed, and averages the resulting pile shapes.
+    PileShape SettledPile(const QString& scenario, int size, quint32 seed, int runs, bool rowKernels, int maxTicks){
+        PileShape average;
+        for(int run = 0; run < runs; ++run){
+            Engine engine(0, 0);
+            engine.SetRowKernels(rowKernels);
+            engine.SetSeed(seed + run);
+            BenchmarkScenarios::Build(scenario, size, seed + run, engine);
+            for(int tick = 0; tick < maxTicks && ( tick == 0 || engine.ActiveChunkCount() > 0 ); ++tick){
+                engine.Step();
+            }
+            const PileShape shape = MeasurePile(engine);
+            average.cells     += shape.cells     / runs;
+            average.baseWidth += shape.baseWidth / runs;
+            average.maxHeight += shape.maxHeight / runs;
+            average.meanSlope += shape.meanSlope / runs;
+        }
+        return average;
+    }
+
+    QJsonObject ToJson(const PileShape& shape){
+        QJsonObject object;
+        object["cells"]      = shape.cells;
+        object["base_width"] = shape.baseWidth;
+        object["max_height"] = shape.maxHeight;
+        object["mean_slope"] = shape.meanSlope;
+        return object;
+    }
+
+    double RelativeDifference(double reference, double value){
+        return reference != 0.0 ? std::abs(value - reference) / reference : std::abs(value);
+    }
+
+    // Settles the scenario with the per-cell reference and with the row kernels and compares the piles they leave.
+    // The two move cells in a different order and at different speeds, so only the statistics should agree:
+    // the same amount of powder, and heaps of about the same height, width and slope.
+    QJsonObject ComparePiles(const QString& scenario, int size, quint32 seed, int runs, int maxTicks, double tolerance, bool* equivalent){
+        const PileShape reference = SettledPile(scenario, size, seed, runs, false, maxTicks);
+        const PileShape row       = SettledPile(scenario, size, seed, runs, true,  maxTicks);
+
+        QJsonObject differences;
+        differences["base_width"] = RelativeDifference(reference.baseWidth, row.baseWidth);
+        differences["max_height"] = RelativeDifference(reference.maxHeight, row.maxHeight);
+        differences["mean_slope"] = RelativeDifference(reference.meanSlope, row.meanSlope);
+
+        *equivalent = reference.cells == row.cells;
+        for(const QString& key : differences.keys()){
+            *equivalent = *equivalent && differences[key].toDouble() <= tolerance;
+        }
+
+        QJsonObject result;
+        result["scenario"]             = scenario;
+        result["size"]                 = size;
+        result["seed"]                 = static_cast<qint64>(seed);
+        result["runs"]                 = runs;
+        result["cell"]                 = ToJson(reference);
+        result["row"]                  = ToJson(row);
+        result["relative_differences"] = differences;
+        result["tolerance"]            = tolerance;
+        result["equivalent"]           = *equivalent;
+        return result;
+    }
+
+    // Where the only powder cell of the world is, or (-1, -1) if there is none.
+    QPoint FindGrain(const CellGrid& cells){
+        for(int index = 0; index < cells.Count(); ++index){
+            if(Mat::UsesRowKernel(static_cast<Mat::Material>(cells.material[index]))){
+                return QPoint(index % cells.Width(), index / cells.Width());
+            }
+        }
+        return QPoint(-1, -1);
+    }
+
+    // Drops a single grain of sand at grain, with wood on ledge, in a width x height world and follows it with the row
+    // kernels until well after it rests. Every tick it may take one step, straight down by up to its FallSpeed or a cell diagonally
+    // down, however the chunks it crosses are updated. A grain carried into a chunk or phase that updates after its
+    // own and moved again would go further.
+    QJsonObject CheckSteps(const QString& name, int width, int height, const QRect& ledge, const QPoint& grain, int threads, bool* valid){
+        Engine engine(width, height);
+        engine.SetThreadCount(threads);
+        engine.SetRowKernels(true);
+        engine.FillRect(ledge, Mat::Material::WOOD);
+        engine.SetTile(Tile(grain, Mat::Material::SAND));
+
+        *valid = true;
+        QString failure;
+        QPoint position = grain;
+        int tick = 0;
+        for(; tick < 2 * height; ++tick){
+            const int speed = FallSpeed(engine.Cells().velocity[engine.Cells().Index(position.x(), position.y())]);
+            engine.Step();
+            const QPoint next = FindGrain(engine.Cells());
+            const int dx = next.x() - position.x();
+            const int dy = next.y() - position.y();
+            if(!( dx == 0 && dy >= 0 && dy <= speed ) && !( std::abs(dx) == 1 && dy == 1 )){
+                *valid  = false;
+                failure = QString("tick %1: (%2, %3) to (%4, %5) at speed %6").arg(tick).arg(position.x()).arg(position.y())
+                                                                                 .arg(next.x()).arg(next.y()).arg(speed);
+                break;
+            }
+            position = next;
+        }
+
+        QJsonObject result;
+        result["case"]    = name;
+        result["threads"] = threads;
+        result["ticks"]   = tick;
+        result["valid"]   = *valid;
+        if(!*valid){
+            result["failure"] = failure;
+        }
+        return result;
+    }
+
+    // Rests a grain of sand on a ledge of wood until its chunk has slept for restTicks ticks, takes the ledge away
+    // and steps once. A cell left alone for a while is not one already moved this tick, so the grain has to fall
+    // straight away, with no update of the tick skipped.
+    QJsonObject CheckWake(const QString& name, int restTicks, bool rowKernels, int threads, bool* valid){
+        const int size = Engine::ChunkSize;
+        Engine engine(size, size);
+        engine.SetThreadCount(threads);
+        engine.SetRowKernels(rowKernels);
+        engine.FillRect(QRect(size / 2 - 1, size / 2, 3, 1), Mat::Material::WOOD);
+        engine.SetTile(Tile(QPoint(size / 2, size / 2 - 1), Mat::Material::SAND));
+        int settled = 0;
+        do{
+            engine.Step();
+            ++settled;
+        }while(engine.ActiveChunkCount() > 0 && settled < 8 * size);
+        engine.Step(restTicks);
+        engine.SetTile(Tile(QPoint(size / 2, size / 2), Mat::Material::EMPTY));
+        engine.Step();
+
+        const CellGrid& cells = engine.Cells();
+        const bool fell = cells.material[cells.Index(size / 2, size / 2 - 1)] == Mat::Material::EMPTY;
+        *valid = fell && engine.SkippedUpdateCount() == 0;
+
+        QJsonObject result;
+        result["case"]        = name;
+        result["row_kernels"] = rowKernels;
+        result["threads"]     = threads;
+        result["ticks"]       = settled + restTicks + 1;
+        result["fell"]        = fell;
+        result["skipped"]     = engine.SkippedUpdateCount();
+        result["valid"]       = *valid;
+        return result;
+    }
+
+    // Fills a two row world with random materials, densities, speeds and flags, and decides every block of the top row
+    // that has a cell either side of it with both the scalar and the SSE2 row kernel masks, for either tick parity.
+    // Counts the blocks where their masks or stamps differ, which should be none.
+    QJsonObject CheckMasks(quint32 seed, int rows, bool* valid){
+        const int width = 64;
+        const int block = 16;
+        std::mt19937 random(seed);
+        CellGrid cells;
+        cells.Resize(width, 2);
+
+        qint64 blocks     = 0;
+        qint64 mismatches = 0;
+        for(int row = 0; row < rows; ++row){
+            for(int index = 0; index < cells.Count(); ++index){
+                const bool empty = random() % 2;
+                cells.material[index] = empty ? quint8(Mat::Material::EMPTY) : quint8(random() % Mat::MaterialCount);
+                cells.density[index]  = static_cast<quint8>(random());
+                cells.velocity[index] = static_cast<qint8>(random());
+                cells.flags[index]    = static_cast<quint8>(random());
+            }
+            const std::vector<quint8> flags(cells.flags, cells.flags + cells.Count());
+            for(quint8 parity : { quint8(0), quint8(CellFlag::TICK_PARITY) }){
+                for(int x = 1; x + block < width; ++x){
+                    mismatches += !PowderMasksAgree(cells, x, 0, parity);
+                    ++blocks;
+                    std::copy(flags.begin(), flags.end(), cells.flags);
+                }
+            }
+        }
+        *valid = mismatches == 0;
+
+        QJsonObject result;
+        result["rows"]       = rows;
+        result["blocks"]     = blocks;
+        result["mismatches"] = mismatches;
+        result["valid"]      = *valid;
+        return result;
+    }
+
+    // Runs a scenario with its update region limited to the bottom left quarter of the world, as catching up by
+    // TickScheduler::CatchUp::SHRINK_REGION does, and counts the cells that changed further than ChunkReach from
+    // the chunks it covers. Cells moved out of them go no further, and fire and heat keep to them, so none should.
+    QJsonObject CheckRegion(const QString& scenario, int size, quint32 seed, int threads, int ticks, bool* valid){
+        Engine engine(0, 0);
+        engine.SetThreadCount(threads);
+        engine.SetSeed(seed);
+        BenchmarkScenarios::Build(scenario, size, seed, engine);
+        engine.SetUpdateRegion(QRect(0, size / 2, size / 2, size / 2));
+
+        const CellGrid& cells = engine.Cells();
+        const std::vector<quint8> material(cells.material, cells.material + cells.Count());
+        const std::vector<qint8>  velocity(cells.velocity, cells.velocity + cells.Count());
+        const std::vector<quint8> flags(cells.flags, cells.flags + cells.Count());
+        const std::vector<float>  temperature(cells.temperature, cells.temperature + cells.Count());
+        engine.Step(ticks);
+
+        const QRect reached = engine.UpdatedArea().adjusted(-Engine::ChunkReach, -Engine::ChunkReach, Engine::ChunkReach, Engine::ChunkReach);
+        qint64 inside  = 0;
+        qint64 outside = 0;
+        for(int index = 0; index < cells.Count(); ++index){
+            // Parity flips on every cell an update visits, so it says nothing about whether the cell changed.
+            const quint8 mask = static_cast<quint8>(~CellFlag::TICK_PARITY);
+            if(cells.material[index] != material[index] || cells.velocity[index] != velocity[index]
+               || ( cells.flags[index] & mask ) != ( flags[index] & mask ) || cells.temperature[index] != temperature[index]){
+                ( reached.contains(index % cells.Width(), index / cells.Width()) ? inside : outside ) += 1;
+            }
+        }
+        *valid = outside == 0 && inside > 0;
+
+        QJsonObject result;
+        result["scenario"]        = scenario;
+        result["size"]            = size;
+        result["threads"]         = threads;
+        result["ticks"]           = ticks;
+        result["changed_inside"]  = inside;
+        result["changed_outside"] = outside;
+        result["valid"]           = *valid;
+        return result;
+    }
+
+    bool SameCells(const CellGrid& a, const CellGrid& b){
+        const size_t count = static_cast<size_t>(a.Count());
+        return a.Width() == b.Width() && a.Height() == b.Height()
+            && std::memcmp(a.material,    b.material,    count)                 == 0
+            && std::memcmp(a.density,     b.density,     count)                 == 0
+            && std::memcmp(a.temperature, b.temperature, count * sizeof(float)) == 0
+            && std::memcmp(a.velocity,    b.velocity,    count)                 == 0
+            && std::memcmp(a.flags,       b.flags,       count)                 == 0;
+    }
+
+    // Builds and warms up one scenario, then times saving it as a snapshot and loading it into a fresh engine,
+    // and checks the loaded world is identical.
+    QJsonObject RunSnapshotCase(const QString& scenario, int size, quint32 seed, int warmupTicks, Snapshot::Compression compression, bool* identical){
+        Engine engine(0, 0);
+        engine.SetSeed(seed);
+        BenchmarkScenarios::Build(scenario, size, seed, engine);
+        engine.Step(warmupTicks);
+
+        const QString path = QDir::temp().filePath(QString("PixelPhysicsBench-%0-%1.snapshot").arg(scenario).arg(size));
+        QElapsedTimer timer;
+        QString error;
+
+        timer.start();
+        const bool saved = Snapshot::Save(path, engine, compression, &error);
+        const qint64 saveNanoseconds = timer.nsecsElapsed();
+        const qint64 fileBytes = QFile(path).size();
+
+        Engine loaded(0, 0);
+        timer.start();
+        const bool wasLoaded = saved && Snapshot::Load(path, loaded, &error);
+        const qint64 loadNanoseconds = timer.nsecsElapsed();
+        QFile::remove(path);
+
+        *identical = wasLoaded && SameCells(engine.Cells(), loaded.Cells())
+                  && loaded.Seed() == engine.Seed() && loaded.TickCount() == engine.TickCount();
+
+        QJsonObject result;
+        result["scenario"]    = scenario;
+        result["size"]        = size;
+        result["compression"] = compression == Snapshot::Compression::RLE ? "rle" : "none";
+        result["file_bytes"]  = fileBytes;
+        result["raw_bytes"]   = static_cast<qint64>(engine.Cells().Count()) * CellGrid::BytesPerCell;
+        result["save_ms"]     = saveNanoseconds / 1e6;
+        result["load_ms"]     = loadNanoseconds / 1e6;
+        result["identical"]   = *identical;
+        if(!error.isEmpty()){
+            result["error"] = error;
+        }
+        return result;
+    }
+
+    // Same as SameCells, but ignoring the tick parity bit, which a recording does not keep.
+    bool SameRecordedCells(const CellGrid& a, const CellGrid& b){
+        const size_t count = static_cast<size_t>(a.Count());
+        if(a.Width() != b.Width() || a.Height() != b.Height()
+        || std::memcmp(a.material,    b.material,    count)                 != 0
+        || std::memcmp(a.density,     b.density,     count)                 != 0
+        || std::memcmp(a.temperature, b.temperature, count * sizeof(float)) != 0
+        || std::memcmp(a.velocity,    b.velocity,    count)                 != 0){
+            return false;
+        }
+        for(size_t i = 0; i < count; ++i){
+            if(( a.flags[i] ^ b.flags[i] ) & ~CellFlag::TICK_PARITY) return false;
+        }
+        return true;
+    }
+
+    // Runs one scenario twice side by side, one engine recorded and one not, alternating ticks so both see the same
+    // machine noise, and reports how much recording slows a tick down. Then replays the recording to the middle and
+    // the end and checks both against the world a plain run had at those ticks.
+    QJsonObject RunRecordingCase(const QString& scenario, int size, quint32 seed, int threads, int warmupTicks, int ticks, int keyframeInterval, bool* identical){
+        Engine plain(0, 0);
+        Engine recorded(0, 0);
+        for(Engine* engine : { &plain, &recorded }){
+            engine->SetThreadCount(threads);
+            engine->SetSeed(seed);
+            BenchmarkScenarios::Build(scenario, size, seed, *engine);
+            engine->Step(warmupTicks);
+        }
+
+        const QString path = QDir::temp().filePath(QString("PixelPhysicsBench-%0-%1.recording").arg(scenario).arg(size));
+        QString error;
+        Recorder recorder;
+        bool ok = recorder.Start(path, recorded, keyframeInterval, &error);
+
+        std::vector<qint64> plainNanoseconds;
+        std::vector<qint64> recordedNanoseconds;
+        plainNanoseconds.reserve(ticks);
+        recordedNanoseconds.reserve(ticks);
+        QElapsedTimer timer;
+        for(int i = 0; i < ticks && ok; ++i){
+            timer.start();
+            plain.Step();
+            plainNanoseconds.push_back(timer.nsecsElapsed());
+            timer.start();
+            recorded.Step();
+            recordedNanoseconds.push_back(timer.nsecsElapsed());
+        }
+        ok = recorder.Finish(&error) && ok;
+        const qint64 fileBytes = QFile(path).size();
+        std::sort(plainNanoseconds.begin(), plainNanoseconds.end());
+        std::sort(recordedNanoseconds.begin(), recordedNanoseconds.end());
+
+        // The middle tick is rebuilt by a third engine, since the plain one has long passed it.
+        const quint64 middleTick = static_cast<quint64>(warmupTicks + ticks / 2);
+        Engine middle(0, 0);
+        middle.SetThreadCount(threads);
+        middle.SetSeed(seed);
+        BenchmarkScenarios::Build(scenario, size, seed, middle);
+        middle.Step(static_cast<int>(middleTick));
+
+        Replay replay;
+        Engine replayed(0, 0);
+        ok = ok && replay.Open(path, &error);
+        timer.start();
+        const bool middleOk = ok && replay.Seek(middleTick, replayed, &error) && SameRecordedCells(replayed.Cells(), middle.Cells());
+        const qint64 seekMiddleNanoseconds = timer.nsecsElapsed();
+        timer.start();
+        const bool endOk = ok && replay.Seek(plain.TickCount(), replayed, &error) && SameRecordedCells(replayed.Cells(), plain.Cells());
+        const qint64 seekEndNanoseconds = timer.nsecsElapsed();
+        QFile::remove(path);
+
+        *identical = middleOk && endOk;
+        const double plainMedian    = ticks > 0 ? Percentile(plainNanoseconds, 0.5)    : 0.0;
+        const double recordedMedian = ticks > 0 ? Percentile(recordedNanoseconds, 0.5) : 0.0;
+
+        QJsonObject result;
+        result["scenario"]                = scenario;
+        result["size"]                    = size;
+        result["threads"]                 = plain.ThreadCount();
+        result["ticks"]                   = ticks;
+        result["keyframe_interval"]       = keyframeInterval;
+        result["keyframes"]               = replay.KeyframeCount();
+        result["file_bytes"]              = fileBytes;
+        result["bytes_per_tick"]          = ticks > 0 ? static_cast<double>(fileBytes) / ticks : 0.0;
+        result["median_tick_ms"]          = plainMedian;
+        result["recorded_median_tick_ms"] = recordedMedian;
+        result["overhead"]                = plainMedian > 0 ? recordedMedian / plainMedian - 1 : 0.0;
+        result["seek_middle_ms"]          = seekMiddleNanoseconds / 1e6;
+        result["seek_end_ms"]             = seekEndNanoseconds / 1e6;
+        result["identical"]               = *identical;
+        if(!error.isEmpty()){
+            result["error"] = error;
+        }
+        return result;
+    }
+
+    // Writes the results as a report of the named suite to outputPath, or to stdout if it is empty.
+    bool WriteSuite(const QString& suite, const QJsonArray& results, const QString& outputPath, QTextStream& err){
+        QJsonObject report;
+        report["suite"]   = suite;
+        report["version"] = 1;
+        report["results"] = results;
+        const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+        if(outputPath.isEmpty()){
+            QTextStream(stdout) << json;
+            return true;
+        }
+        QFile file(outputPath);
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+            err << "Could not write " << outputPath << ": " << file.errorString() << "\n";
+            return false;
+        }
+        file.write(json);
+        return true;
+    }
+
+    // Runs one case in a child process so its peak RSS is not polluted by earlier, larger cases.
+    QJsonObject RunCaseIsolated(const QString& scenario, int size, const QStringList& passthroughArguments, QString* error){
+        QProcess child;
+        QStringList arguments = passthroughArguments;
+        arguments << "--run-one" << "--scenario" << scenario << "--size" << QString::number(size);
+        child.start(QCoreApplication::applicationFilePath(), arguments);
+        if(!child.waitForFinished(-1) || child.exitStatus() != QProcess::NormalExit || child.exitCode() != 0){
+            *error = QString("%0 at %1 failed: %2").arg(scenario).arg(size).arg(QString::fromLocal8Bit(child.readAllStandardError()));
+            return QJsonObject();
+        }
+        return QJsonDocument::fromJson(child.readAllStandardOutput()).object();
+    }
+
+}
+
+// Macro benchmark suite: runs seeded scenarios at several world sizes and reports tick time percentiles,
+// cells updated per second and peak RSS as JSON, so two builds can be diffed.
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    QCoreApplication::setApplicationName("PixelPhysicsBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs the PixelPhysicsEngine macro benchmarks and prints the results as JSON.");
+    parser.addHelpOption();
+
+    QCommandLineOption scenarioOption("scenario", "Only run this scenario: " + BenchmarkScenarios::Names().join(", ") + ".", "name");
+    QCommandLineOption sizeOption("size", "Only run this world size.", "cells");
+    QCommandLineOption sizesOption("sizes", "Comma separated world sizes.", "cells", "256,1024,4096");
+    QCommandLineOption ticksOption("ticks", "Measured ticks per case. Defaults to fewer ticks for larger worlds.", "ticks", "0");
+    QCommandLineOption warmupOption("warmup", "Unmeasured ticks before measuring.", "ticks", "5");
+    QCommandLineOption threadsOption("threads", "Number of update threads.", "threads", "1");
+    QCommandLineOption seedOption("seed", "Seed for scenario generation and the simulation.", "seed", "1");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Write the JSON report to this file instead of stdout.", "file");
+    QCommandLineOption kernelsOption("kernels", "How powders are updated: 'row' for the row kernels or 'cell' for the per-cell reference.", "kernels", "row");
+    QCommandLineOption compareOption("compare-kernels", "Instead of timing, settle a dry powder --scenario (default sand_pile) with both kernels and check the piles match.");
+    QCommandLineOption stepsOption("check-steps", "Instead of timing, drop single grains across chunk edges, serially and in parallel, and check none moves twice in a tick.");
+    QCommandLineOption masksOption("check-masks", "Instead of timing, decide random rows with both the scalar and the SSE2 row kernel masks and check they agree.");
+    QCommandLineOption regionOption("check-region", "Instead of timing, run the fire and heat scenarios with the update region limited as catching up does, and check nothing changes outside it.");
+    QCommandLineOption snapshotOption("snapshot", "Instead of timing ticks, time saving and loading every case as a snapshot, with and without RLE, and check the round trip.");
+    QCommandLineOption recordOption("record", "Instead of timing ticks alone, time every case with and without recording it, and check replaying the recording.");
+    QCommandLineOption keyframeOption("keyframe-interval", "Ticks between keyframes for --record.", "ticks", QString::number(Recording::DefaultKeyframeInterval));
+    QCommandLineOption inProcessOption("in-process", "Run every case in this process. Faster, but peak RSS only ever grows.");
+    QCommandLineOption runOneOption("run-one", "Internal: run a single --scenario/--size case and print its result.");
+    parser.addOption(scenarioOption);
+    parser.addOption(sizeOption);
+    parser.addOption(sizesOption);
+    parser.addOption(ticksOption);
+    parser.addOption(warmupOption);
+    parser.addOption(threadsOption);
+    parser.addOption(seedOption);
+    parser.addOption(outputOption);
+    parser.addOption(kernelsOption);
+    parser.addOption(compareOption);
+    parser.addOption(stepsOption);
+    parser.addOption(masksOption);
+    parser.addOption(regionOption);
+    parser.addOption(snapshotOption);
+    parser.addOption(recordOption);
+    parser.addOption(keyframeOption);
+    parser.addOption(inProcessOption);
+    parser.addOption(runOneOption);
+    parser.process(application);
+
+    QTextStream err(stderr);
+
+    const quint32 seed    = parser.value(seedOption).toUInt();
+    const int     threads = std::max(1, parser.value(threadsOption).toInt());
+    const int     warmup  = std::max(0, parser.value(warmupOption).toInt());
+    const int     ticks   = parser.value(ticksOption).toInt();
+    const QString kernels = parser.value(kernelsOption);
+    if(kernels != "row" && kernels != "cell"){
+        err << "Unknown kernels " << kernels << "\n";
+        return 1;
+    }
+    const bool rowKernels = kernels == "row";
+
+    QStringList scenarios = BenchmarkScenarios::Names();
+    if(parser.isSet(scenarioOption)){
+        if(!scenarios.contains(parser.value(scenarioOption))){
+            err << "Unknown scenario " << parser.value(scenarioOption) << "\n";
+            return 1;
+        }
+        scenarios = QStringList() << parser.value(scenarioOption);
+    }
+
+    QVector<int> sizes;
+    const QStringList sizeStrings = parser.isSet(sizeOption) ? QStringList() << parser.value(sizeOption) : parser.value(sizesOption).split(',', Qt::SkipEmptyParts);
+    for(const QString& sizeString : sizeStrings){
+        bool ok = false;
+        const int size = sizeString.toInt(&ok);
+        if(!ok || size <= 0){
+            err << "Invalid size " << sizeString << "\n";
+            return 1;
+        }
+        sizes.append(size);
+    }
+
+    if(parser.isSet(compareOption)){
+        const QString scenario = parser.isSet(scenarioOption) ? scenarios.first() : QString("sand_pile");
+        const int     size     = parser.isSet(sizeOption) ? sizes.first() : 256;
+        bool equivalent = false;
+        const QJsonObject result = ComparePiles(scenario, size, seed, 5, ticks > 0 ? ticks : 20 * size, 0.1, &equivalent);
+        QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Indented);
+        return equivalent ? 0 : 1;
+    }
+
+    if(parser.isSet(stepsOption)){
+        // A grain sliding off a ledge from the last column of one chunk into the next, which updates after it, and one
+        // falling from the last row of a chunk into the awake chunk below, whose checkerboard phase updates after its own.
+        // Then one let go after resting, which must fall at once.
+        const int edge = Engine::ChunkSize;
+        QJsonArray results;
+        bool allValid = true;
+        for(int stepThreads : { 1, std::max(threads, 2) }){
+            bool valid = false;
+            results.append(CheckSteps("column_edge_slide", 3 * edge, 3 * edge, QRect(edge - 2, edge + 9, 2, 1), QPoint(edge - 1, edge + 8), stepThreads, &valid));
+            allValid = allValid && valid;
+            results.append(CheckSteps("chunk_row_fall", 2 * edge, 8 * edge, QRect(), QPoint(10, 2 * edge - 1), stepThreads, &valid));
+            allValid = allValid && valid;
+            // Both parities of sleep, with and without the row kernels.
+            for(int restTicks : { 0, 1 }){
+                for(bool rowKernels : { false, true }){
+                    results.append(CheckWake("wake_after_rest", restTicks, rowKernels, stepThreads, &valid));
+                    allValid = allValid && valid;
+                }
+            }
+        }
+        return WriteSuite("PixelPhysicsBench steps", results, parser.value(outputOption), err) && allValid ? 0 : 1;
+    }
+
+    if(parser.isSet(masksOption)){
+        bool valid = false;
+        QJsonArray results;
+        results.append(CheckMasks(seed, 10000, &valid));
+        return WriteSuite("PixelPhysicsBench masks", results, parser.value(outputOption), err) && valid ? 0 : 1;
+    }
+
+    if(parser.isSet(regionOption)){
+        const QStringList regionScenarios = parser.isSet(scenarioOption) ? scenarios : QStringList() << "hot_plate" << "forest_fire" << "boiling_lake";
+        const int size = parser.isSet(sizeOption) ? sizes.first() : 256;
+        QJsonArray results;
+        bool allValid = true;
+        for(const QString& scenario : regionScenarios){
+            for(int regionThreads : { 1, std::max(threads, 2) }){
+                bool valid = false;
+                results.append(CheckRegion(scenario, size, seed, regionThreads, ticks > 0 ? ticks : 200, &valid));
+                allValid = allValid && valid;
+            }
+        }
+        return WriteSuite("PixelPhysicsBench region", results, parser.value(outputOption), err) && allValid ? 0 : 1;
+    }
+
+    if(parser.isSet(snapshotOption)){
+        QJsonArray results;
+        bool allIdentical = true;
+        for(int size : sizes){
+            for(const QString& scenario : scenarios){
+                for(Snapshot::Compression compression : { Snapshot::Compression::NONE, Snapshot::Compression::RLE }){
+                    bool identical = false;
+                    const QJsonObject result = RunSnapshotCase(scenario, size, seed, warmup, compression, &identical);
+                    err << scenario << " " << size << " " << result["compression"].toString() << ": save " << result["save_ms"].toDouble()
+                        << " ms, load " << result["load_ms"].toDouble() << " ms" << ( identical ? "" : ", MISMATCH" ) << "\n";
+                    err.flush();
+                    allIdentical = allIdentical && identical;
+                    results.append(result);
+                }
+            }
+        }
+        return WriteSuite("PixelPhysicsBench snapshot", results, parser.value(outputOption), err) && allIdentical ? 0 : 1;
+    }
+
+    if(parser.isSet(recordOption)){
+        const int keyframeInterval = std::max(1, parser.value(keyframeOption).toInt());
+        QJsonArray results;
+        bool allIdentical = true;
+        for(int size : sizes){
+            for(const QString& scenario : scenarios){
+                bool identical = false;
+                const QJsonObject result = RunRecordingCase(scenario, size, seed, threads, warmup, ticks > 0 ? ticks : DefaultTicks(size), keyframeInterval, &identical);
+                err << scenario << " " << size << ": median " << result["median_tick_ms"].toDouble() << " ms, recorded "
+                    << result["recorded_median_tick_ms"].toDouble() << " ms, " << result["bytes_per_tick"].toDouble() << " bytes/tick"
+                    << ( identical ? "" : ", MISMATCH" ) << "\n";
+                err.flush();
+                allIdentical = allIdentical && identical;
+                results.append(result);
+            }
+        }
+        return WriteSuite("PixelPhysicsBench recording", results, parser.value(outputOption), err) && allIdentical ? 0 : 1;
+    }
+
+    if(parser.isSet(runOneOption)){
+        const int size = sizes.first();
+        QJsonObject result = RunCase(scenarios.first(), size, seed, threads, rowKernels, warmup, ticks > 0 ? ticks : DefaultTicks(size));
+        QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact);
+        return 0;
+    }
+
+    const QStringList passthroughArguments = QStringList() << "--seed"    << QString::number(seed)
+                                                           << "--threads" << QString::number(threads)
+                                                           << "--warmup"  << QString::number(warmup)
+                                                           << "--ticks"   << QString::number(ticks)
+                                                           << "--kernels" << kernels;
+    QJsonArray results;
+    for(int size : sizes){
+        for(const QString& scenario : scenarios){
+            QJsonObject result;
+            if(parser.isSet(inProcessOption)){
+                result = RunCase(scenario, size, seed, threads, rowKernels, warmup, ticks > 0 ? ticks : DefaultTicks(size));
+            }else{
+                QString error;
+                result = RunCaseIsolated(scenario, size, passthroughArguments, &error);
+                if(result.isEmpty()){
+                    err << error << "\n";
+                    return 1;
+                }
+            }
+            err << scenario << " " << size << ": median " << result["median_tick_ms"].toDouble() << " ms\n";
+            err.flush();
+            results.append(result);
+        }
+    }
+
+    return WriteSuite("PixelPhysicsBench", results, parser.value(outputOption), err) ? 0 : 1;
+}
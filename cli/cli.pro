@@ -0,0 +1,11 @@
+QT       = core
+
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+TARGET   = PixelPhysicsCli
+QMAKE_CXXFLAGS += -Wall -Wextra -pedantic -Wshadow
+
+include(../core/core.pri)
+
+SOURCES += \
+    main.cpp
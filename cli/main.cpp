@@ -0,0 +1,212 @@
+#include "Engine.h"
+#include "Recording.h"
+#include "Scenario.h"
+#include "Snapshot.h"
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+#include <vector>
+
+// Hash of every cell's material and flags. Same seed, scenario, ticks and thread count give the same checksum.
+// The tick parity bit only says which tick last visited a cell, so it is left out and a replayed world hashes the same.
+static QByteArray Checksum(const CellGrid& grid){
+    const int gridSize = grid.Width() * grid.Height();
+    std::vector<quint8> flags(grid.flags, grid.flags + gridSize);
+    for(quint8& flag : flags){
+        flag &= ~CellFlag::TICK_PARITY;
+    }
+    QCryptographicHash checksum(QCryptographicHash::Sha1);
+    checksum.addData(reinterpret_cast<const char*>(grid.material), gridSize);
+    checksum.addData(reinterpret_cast<const char*>(flags.data()), gridSize);
+    return checksum.result().toHex();
+}
+
+// Headless batch runner: loads a scenario, simulates it as fast as possible and reports throughput.
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    QCoreApplication::setApplicationName("PixelPhysicsCli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs a PixelPhysicsEngine scenario without rendering and reports ticks/sec and cells/sec.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("scenario", "Scenario, snapshot or recording file to load.");
+
+    QCommandLineOption ticksOption(QStringList() << "n" << "ticks", "Number of ticks to simulate.", "ticks", "1000");
+    QCommandLineOption threadsOption(QStringList() << "t" << "threads", "Number of update threads.", "threads", QString::number(QThread::idealThreadCount()));
+    QCommandLineOption seedOption(QStringList() << "s" << "seed", "Seed for the simulation's random choices.", "seed", QString::number(Engine::DefaultSeed));
+    parser.addOption(ticksOption);
+    parser.addOption(threadsOption);
+    QCommandLineOption saveOption("save", "Save the world as a snapshot after the run.", "file");
+    QCommandLineOption recordOption("record", "Record the run to a file that can be replayed.", "file");
+    QCommandLineOption keyframeOption("keyframe-interval", "Ticks between keyframes of a recording.", "ticks", QString::number(Recording::DefaultKeyframeInterval));
+    QCommandLineOption seekOption("seek", "Tick of a recording to replay to. Defaults to its last tick.", "tick");
+    QCommandLineOption traceOption("trace", "Write a timeline of the run as Chrome trace JSON. Needs a build with CONFIG+=trace.", "file");
+    QCommandLineOption countersOption("counters", "Write the engine counters of every tick to a CSV file. Needs a core built with CONFIG+=counters.", "file");
+    parser.addOption(seedOption);
+    parser.addOption(saveOption);
+    parser.addOption(recordOption);
+    parser.addOption(keyframeOption);
+    parser.addOption(seekOption);
+    parser.addOption(countersOption);
+    parser.addOption(traceOption);
+    parser.process(application);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList positionalArguments = parser.positionalArguments();
+    if(positionalArguments.size() != 1){
+        parser.showHelp(1);
+    }
+
+    bool ticksOk    = false;
+    bool threadsOk  = false;
+    bool seedOk     = false;
+    bool intervalOk = false;
+    const int ticks    = parser.value(ticksOption).toInt(&ticksOk);
+    const int threads  = parser.value(threadsOption).toInt(&threadsOk);
+    const quint64 seed = parser.value(seedOption).toULongLong(&seedOk);
+    const int keyframeInterval = parser.value(keyframeOption).toInt(&intervalOk);
+    if(!ticksOk || ticks <= 0 || !threadsOk || threads <= 0 || !intervalOk || keyframeInterval <= 0){
+        err << "ticks, threads and keyframe-interval must be positive integers\n";
+        return 1;
+    }
+    if(!seedOk){
+        err << "seed must be a non-negative integer\n";
+        return 1;
+    }
+
+    // A recording is replayed to a tick instead of simulated.
+    Engine engine(0, 0);
+    QString error;
+    const QString& path = positionalArguments.first();
+    if(Replay::IsRecording(path)){
+        Replay replay;
+        if(!replay.Open(path, &error)){
+            err << "Could not open recording: " << error << "\n";
+            return 1;
+        }
+        bool seekOk = true;
+        const quint64 tick = parser.isSet(seekOption) ? parser.value(seekOption).toULongLong(&seekOk) : replay.LastTick();
+        QElapsedTimer timer;
+        timer.start();
+        if(!seekOk || !replay.Seek(tick, engine, &error)){
+            err << "Could not replay to tick " << parser.value(seekOption) << ": " << ( seekOk ? error : QString("not a tick") ) << "\n";
+            return 1;
+        }
+        const double seconds = timer.nsecsElapsed() / 1e9;
+
+        out << "world:     " << engine.Width() << "x" << engine.Height() << "\n"
+            << "recorded:  ticks " << replay.FirstTick() << " to " << replay.LastTick() << ", " << replay.KeyframeCount() << " keyframes\n"
+            << "tick:      " << engine.TickCount() << " in " << seconds << " s\n"
+            << "seed:      " << engine.Seed() << "\n"
+            << "checksum:  " << Checksum(engine.Cells()) << "\n";
+
+        if(parser.isSet(saveOption) && !Snapshot::Save(parser.value(saveOption), engine, Snapshot::Compression::RLE, &error)){
+            err << "Could not save snapshot: " << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // A snapshot brings its own seed and tick count, so a saved run continues exactly unless --seed overrides it.
+    const bool isSnapshot = Snapshot::IsSnapshot(path);
+    if(isSnapshot ? !Snapshot::Load(path, engine, &error) : !Scenario::Load(path, engine, &error)){
+        err << "Could not load " << ( isSnapshot ? "snapshot" : "scenario" ) << ": " << error << "\n";
+        return 1;
+    }
+    engine.SetThreadCount(threads);
+    if(!isSnapshot || parser.isSet(seedOption)){
+        engine.SetSeed(seed);
+    }
+
+    Recorder recorder;
+    if(parser.isSet(recordOption) && !recorder.Start(parser.value(recordOption), engine, keyframeInterval, &error)){
+        err << "Could not record: " << error << "\n";
+        return 1;
+    }
+
+    QFile countersFile;
+    QTextStream counters(&countersFile);
+    if(parser.isSet(countersOption)){
+        if(!Counters::Enabled()){
+            err << "Could not write counters: built without them, rebuild with qmake CONFIG+=counters\n";
+            return 1;
+        }
+        countersFile.setFileName(parser.value(countersOption));
+        if(!countersFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)){
+            err << "Could not write counters: " << countersFile.errorString() << "\n";
+            return 1;
+        }
+        counters << Counters::CsvHeader() << "\n";
+    }
+
+    if(parser.isSet(traceOption)){
+        if(!Trace::Enabled()){
+            err << "Could not trace: built without trace zones, rebuild with qmake CONFIG+=trace\n";
+            return 1;
+        }
+        Trace::SetThreadName("Main");
+        Trace::Start();
+    }
+
+    // With counters the run ticks one at a time to read each tick's counters, and writes them once it is timed.
+    std::vector<TickCounters> tickCounters;
+    QElapsedTimer timer;
+    timer.start();
+    if(countersFile.isOpen()){
+        tickCounters.reserve(ticks);
+        for(int i = 0; i < ticks; ++i){
+            engine.Step();
+            tickCounters.push_back(engine.LastTickCounters());
+        }
+    }else{
+        engine.Step(ticks);
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    if(parser.isSet(traceOption)){
+        Trace::Stop();
+        if(!Trace::Save(parser.value(traceOption), &error)){
+            err << "Could not save trace: " << error << "\n";
+            return 1;
+        }
+    }
+
+    for(const TickCounters& tick : tickCounters){
+        counters << Counters::CsvRow(tick) << "\n";
+    }
+    counters.flush();
+    if(countersFile.isOpen() && countersFile.error() != QFileDevice::NoError){
+        err << "Could not write counters: " << countersFile.errorString() << "\n";
+        return 1;
+    }
+
+    if(!recorder.Finish(&error)){
+        err << "Could not record: " << error << "\n";
+        return 1;
+    }
+
+    const double cells = static_cast<double>(engine.Width()) * engine.Height();
+    out << "world:     " << engine.Width() << "x" << engine.Height() << "\n"
+        << "threads:   " << engine.ThreadCount() << "\n"
+        << "ticks:     " << ticks << " in " << seconds << " s\n"
+        << "ticks/sec: " << ticks / seconds << "\n"
+        << "cells/sec: " << cells * ticks / seconds << "\n"
+        << "seed:      " << engine.Seed() << "\n"
+        << "checksum:  " << Checksum(engine.Cells()) << "\n";
+
+    if(parser.isSet(saveOption) && !Snapshot::Save(parser.value(saveOption), engine, Snapshot::Compression::RLE, &error)){
+        err << "Could not save snapshot: " << error << "\n";
+        return 1;
+    }
+
+    return 0;
+}
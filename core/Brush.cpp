@@ -0,0 +1,92 @@
+#include "Brush.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    // Widens minX..maxX to take in where the row y crosses the edge from a to b, if it does.
+    void CrossRow(const QPointF& a, const QPointF& b, double y, double& minX, double& maxX){
+        if(( y < a.y() && y < b.y() ) || ( y > a.y() && y > b.y() )){
+            return;
+        }
+        if(a.y() == b.y()){
+            minX = std::min(minX, std::min(a.x(), b.x()));
+            maxX = std::max(maxX, std::max(a.x(), b.x()));
+            return;
+        }
+        const double x = a.x() + ( y - a.y() ) * ( b.x() - a.x() ) / ( b.y() - a.y() );
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+    }
+
+}
+
+// Appends the spans of a filled circle of the given radius around the cell at centerX, centerY.
+void Brush::Circle(int centerX, int centerY, int radius, QVector<Span>& spans){
+    if(radius < 0){
+        return;
+    }
+
+    // Rows are written from the middle outwards, where the half width only ever shrinks.
+    const int first = spans.size();
+    spans.resize(first + 2 * radius + 1);
+
+    const int radiusSquared = radius * radius;
+    int halfWidth = radius;
+    for(int yd = 0; yd <= radius; ++yd){
+        while(halfWidth * halfWidth + yd * yd > radiusSquared){
+            --halfWidth;
+        }
+        spans[first + radius - yd] = Span{ centerY - yd, centerX - halfWidth, centerX + halfWidth };
+        spans[first + radius + yd] = Span{ centerY + yd, centerX - halfWidth, centerX + halfWidth };
+    }
+}
+
+// Appends the spans of the line from start to end stroked width cells wide with square caps.
+void Brush::Line(const QPointF& start, const QPointF& end, double width, QVector<Span>& spans){
+    if(width <= 0.0){
+        return;
+    }
+
+    // The stroke is a rectangle: the line grown by half the width along itself for the caps, and to either side.
+    // A line of no length still gets its caps, as a square facing along x.
+    double dx = end.x() - start.x();
+    double dy = end.y() - start.y();
+    const double length = std::sqrt(dx * dx + dy * dy);
+    if(length > 0.0){
+        dx /= length;
+        dy /= length;
+    }else{
+        dx = 1.0;
+        dy = 0.0;
+    }
+    const QPointF along(dx * width / 2.0, dy * width / 2.0);
+    const QPointF across(-along.y(), along.x());
+    const QPointF corners[4] = {
+        start - along - across,
+        end   + along - across,
+        end   + along + across,
+        start - along + across,
+    };
+
+    double top    = corners[0].y();
+    double bottom = corners[0].y();
+    for(const QPointF& corner : corners){
+        top    = std::min(top, corner.y());
+        bottom = std::max(bottom, corner.y());
+    }
+
+    // The rectangle is convex, so every row crosses it in one run between the outermost edge crossings.
+    for(int y = static_cast<int>(std::ceil(top)); y <= static_cast<int>(std::floor(bottom)); ++y){
+        double minX =  HUGE_VAL;
+        double maxX = -HUGE_VAL;
+        for(int i = 0; i < 4; ++i){
+            CrossRow(corners[i], corners[( i + 1 ) % 4], y, minX, maxX);
+        }
+        const int left  = static_cast<int>(std::ceil(minX));
+        const int right = static_cast<int>(std::floor(maxX));
+        if(left <= right){
+            spans.append(Span{ y, left, right });
+        }
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef BRUSH_H
+#define BRUSH_H
+
+#include "Span.h"
+#include <QPointF>
+#include <QVector>
+
+// Rasterizes the drawing tools' shapes into Spans, one per row they cover, for Engine::FillSpans.
+// Spans are not clipped to any world; the engine clips them as it writes.
+namespace Brush{
+
+    // Appends the spans of a filled circle of the given radius around the cell at centerX, centerY: every cell
+    // whose offset from the centre is within radius. Row widths are found with integer steps, as in the midpoint algorithm.
+    void Circle(int centerX, int centerY, int radius, QVector<Span>& spans);
+
+    // Appends the spans of the line from start to end stroked width cells wide with square caps,
+    // the outline QPainterPathStroker gives by default. A cell is covered when its integer coordinate is inside.
+    void Line(const QPointF& start, const QPointF& end, double width, QVector<Span>& spans);
+
+}
+
+#endif // BRUSH_H
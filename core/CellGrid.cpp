@@ -0,0 +1,124 @@
+#include "CellGrid.h"
+#include "Elements.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace{
+
+    // Every field buffer starts on its own cache line.
+    constexpr size_t FieldAlignment = 64;
+
+    size_t AlignUp(size_t offset){
+        return ( offset + FieldAlignment - 1 ) & ~( FieldAlignment - 1 );
+    }
+
+    // Copies the part of a width x height field that lands inside a newWidth x newHeight one when every cell moves
+    // by shiftX, shiftY, and fills the rest of it with value.
+    template<typename T>
+    void CopyShifted(T* to, int newWidth, int newHeight, const T* from, int width, int height, int shiftX, int shiftY, T value){
+        const int left  = std::clamp(shiftX, 0, newWidth);
+        const int right = std::clamp(shiftX + width, left, newWidth);
+        for(int y = 0; y < newHeight; ++y){
+            T* row = to + static_cast<size_t>(y) * newWidth;
+            const int fromY = y - shiftY;
+            if(fromY < 0 || fromY >= height || left == right){
+                std::fill(row, row + newWidth, value);
+                continue;
+            }
+            std::fill(row, row + left, value);
+            std::memcpy(row + left, from + static_cast<size_t>(fromY) * width + ( left - shiftX ), ( right - left ) * sizeof(T));
+            std::fill(row + right, row + newWidth, value);
+        }
+    }
+
+}
+
+CellGrid::CellGrid() :
+    material(nullptr)
+  , density(nullptr)
+  , temperature(nullptr)
+  , velocity(nullptr)
+  , flags(nullptr)
+  , m_width(0)
+  , m_height(0)
+{
+    Resize(0, 0);
+}
+
+// Reallocates the field buffers for width x height cells and clears every cell to EMPTY.
+void CellGrid::Resize(int width, int height){
+    Allocate(width, height);
+
+    const size_t count = static_cast<size_t>(Count());
+    std::memset(material, Mat::Material::EMPTY,  count);
+    std::memset(density,  Mat::AIR_DENSITY,      count);
+    std::fill(temperature, temperature + count, static_cast<float>(AMBIENT_TEMP));
+    std::memset(velocity, 0, count);
+    std::memset(flags,    0, count);
+}
+
+// Reallocates the field buffers keeping the cells that still fit, each moved by shiftX, shiftY.
+void CellGrid::Resize(int width, int height, int shiftX, int shiftY){
+    // The old buffers stay alive until the kept cells are copied out of them.
+    const std::unique_ptr<unsigned char[]> oldStorage = std::move(m_storage);
+    const int oldWidth  = m_width;
+    const int oldHeight = m_height;
+    const quint8* oldMaterial    = material;
+    const quint8* oldDensity     = density;
+    const float*  oldTemperature = temperature;
+    const qint8*  oldVelocity    = velocity;
+    const quint8* oldFlags       = flags;
+
+    Allocate(width, height);
+
+    CopyShifted(material,    m_width, m_height, oldMaterial,    oldWidth, oldHeight, shiftX, shiftY, quint8(Mat::Material::EMPTY));
+    CopyShifted(density,     m_width, m_height, oldDensity,     oldWidth, oldHeight, shiftX, shiftY, quint8(Mat::AIR_DENSITY));
+    CopyShifted(temperature, m_width, m_height, oldTemperature, oldWidth, oldHeight, shiftX, shiftY, static_cast<float>(AMBIENT_TEMP));
+    CopyShifted(velocity,    m_width, m_height, oldVelocity,    oldWidth, oldHeight, shiftX, shiftY, qint8(0));
+    CopyShifted(flags,       m_width, m_height, oldFlags,       oldWidth, oldHeight, shiftX, shiftY, quint8(0));
+}
+
+// Points the field buffers into a new allocation for width x height cells, leaving them uninitialised.
+void CellGrid::Allocate(int width, int height){
+    m_width  = std::max(width,  0);
+    m_height = std::max(height, 0);
+
+    const size_t count = static_cast<size_t>(Count());
+
+    size_t materialOffset    = 0;
+    size_t densityOffset     = AlignUp(materialOffset    + count * sizeof(quint8));
+    size_t temperatureOffset = AlignUp(densityOffset     + count * sizeof(quint8));
+    size_t velocityOffset    = AlignUp(temperatureOffset + count * sizeof(float));
+    size_t flagsOffset       = AlignUp(velocityOffset    + count * sizeof(qint8));
+    size_t totalSize         = AlignUp(flagsOffset       + count * sizeof(quint8));
+
+    // Over-allocate so the first field can be aligned regardless of what new[] hands back.
+    m_storage.reset(new unsigned char[totalSize + FieldAlignment]);
+    unsigned char* base = m_storage.get();
+    base += AlignUp(reinterpret_cast<uintptr_t>(base)) - reinterpret_cast<uintptr_t>(base);
+
+    material    = base + materialOffset;
+    density     = base + densityOffset;
+    temperature = reinterpret_cast<float*>(base + temperatureOffset);
+    velocity    = reinterpret_cast<qint8*>(base + velocityOffset);
+    flags       = base + flagsOffset;
+}
+
+// Resets one cell to a freshly placed material with default state.
+void CellGrid::Set(int index, quint8 materialIn, quint8 densityIn){
+    material[index]    = materialIn;
+    density[index]     = densityIn;
+    temperature[index] = Mat::MaterialTraits[materialIn].temperature;
+    velocity[index]    = 0;
+    flags[index]       = 0;
+}
+
+// Resets count cells from index on, a field at a time.
+void CellGrid::Fill(int index, int count, quint8 materialIn, quint8 densityIn){
+    std::fill(material    + index, material    + index + count, materialIn);
+    std::fill(density     + index, density     + index + count, densityIn);
+    std::fill(temperature + index, temperature + index + count, Mat::MaterialTraits[materialIn].temperature);
+    std::fill(velocity    + index, velocity    + index + count, qint8(0));
+    std::fill(flags       + index, flags       + index + count, quint8(0));
+}
@@ -0,0 +1,86 @@
+#ifndef CELLGRID_H
+#define CELLGRID_H
+
+#include <QtGlobal>
+#include <memory>
+#include <utility>
+
+// Bits stored in CellGrid::flags.
+namespace CellFlag{
+    enum : quint8{
+        HEADING_LEFT  = 1 << 0, // Last horizontal move was to the left
+        HEADING_RIGHT = 1 << 1, // Last horizontal move was to the right
+        HEADING_MASK  = HEADING_LEFT | HEADING_RIGHT,
+        TICK_PARITY   = 1 << 2, // Parity of the last tick that updated or moved the cell, see Engine::UpdateChunk
+        BURNING       = 1 << 3, // On fire, with the ticks it has left in velocity, see Fire.h
+    };
+}
+
+// Structure-of-arrays storage for every cell of the world.
+// Each field is its own contiguous row-major buffer, all carved out of a single allocation,
+// so a cell is addressed by one flat index and nothing is allocated per cell.
+class CellGrid
+{
+
+public:
+
+    CellGrid();
+
+    CellGrid(const CellGrid&) = delete;
+    CellGrid& operator=(const CellGrid&) = delete;
+
+    // Reallocates the field buffers for width x height cells and clears every cell to EMPTY.
+    void Resize(int width, int height);
+
+    // Reallocates the field buffers for width x height cells keeping the cells that still fit, each moved by
+    // shiftX, shiftY. Kept rows are copied a field at a time and only the cells that are new are cleared to EMPTY.
+    void Resize(int width, int height, int shiftX, int shiftY);
+
+    // Resets one cell to a freshly placed material with default state, at the material's starting temperature.
+    void Set(int index, quint8 materialIn, quint8 densityIn);
+
+    // Resets count cells from index on, as Set would each of them.
+    void Fill(int index, int count, quint8 materialIn, quint8 densityIn);
+
+    // Exchanges every field of two cells.
+    void Swap(int index1, int index2){
+        std::swap(material[index1],    material[index2]);
+        std::swap(density[index1],     density[index2]);
+        std::swap(temperature[index1], temperature[index2]);
+        std::swap(velocity[index1],    velocity[index2]);
+        std::swap(flags[index1],       flags[index2]);
+    }
+
+    int Index(int xPos, int yPos) const{
+        return yPos * m_width + xPos;
+    }
+
+    int Width()  const { return m_width;  }
+    int Height() const { return m_height; }
+    int Count()  const { return m_width * m_height; }
+
+    // Bytes of field storage per cell, not counting alignment padding.
+    static constexpr int BytesPerCell = sizeof(quint8) + sizeof(quint8) + sizeof(float) + sizeof(qint8) + sizeof(quint8);
+
+public:
+
+    quint8* material;    // Mat::Material id
+    quint8* density;     // Mat::DensityClass, compared directly by the rules
+    float*  temperature; // Celsius
+    qint8*  velocity;    // Vertical speed in cells per tick, negative falling, or ticks left to burn for CellFlag::BURNING cells
+    quint8* flags;       // CellFlag bits
+
+protected:
+
+    // Points the field buffers into a new allocation for width x height cells, leaving them uninitialised.
+    void Allocate(int width, int height);
+
+protected:
+
+    int m_width;
+    int m_height;
+    std::unique_ptr<unsigned char[]> m_storage;
+
+};
+
+#endif // CELLGRID_H
@@ -0,0 +1,145 @@
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+// Inclusive cell rectangle that only ever grows until it is cleared.
+struct DirtyRect{
+
+    DirtyRect(){
+        Clear();
+    }
+
+    void Clear(){
+        left   = INT_MAX;
+        top    = INT_MAX;
+        right  = INT_MIN;
+        bottom = INT_MIN;
+    }
+
+    bool IsEmpty() const{
+        return left > right || top > bottom;
+    }
+
+    int Area() const{
+        return IsEmpty() ? 0 : ( right - left + 1 ) * ( bottom - top + 1 );
+    }
+
+    void Expand(int leftIn, int topIn, int rightIn, int bottomIn){
+        left   = std::min(left,   leftIn);
+        top    = std::min(top,    topIn);
+        right  = std::max(right,  rightIn);
+        bottom = std::max(bottom, bottomIn);
+    }
+
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+// DirtyRect that several update threads may grow at once.
+// Reads are relaxed and only a rect that actually grows pays for a compare-exchange.
+struct AtomicDirtyRect{
+
+    AtomicDirtyRect(){
+        Clear();
+    }
+
+    void Clear(){
+        left.store(INT_MAX,   std::memory_order_relaxed);
+        top.store(INT_MAX,    std::memory_order_relaxed);
+        right.store(INT_MIN,  std::memory_order_relaxed);
+        bottom.store(INT_MIN, std::memory_order_relaxed);
+    }
+
+    void Expand(int leftIn, int topIn, int rightIn, int bottomIn){
+        StoreMin(left,   leftIn);
+        StoreMin(top,    topIn);
+        StoreMax(right,  rightIn);
+        StoreMax(bottom, bottomIn);
+    }
+
+    DirtyRect Load() const{
+        DirtyRect rect;
+        rect.left   = left.load(std::memory_order_relaxed);
+        rect.top    = top.load(std::memory_order_relaxed);
+        rect.right  = right.load(std::memory_order_relaxed);
+        rect.bottom = bottom.load(std::memory_order_relaxed);
+        return rect;
+    }
+
+    static void StoreMin(std::atomic<int>& target, int value){
+        int current = target.load(std::memory_order_relaxed);
+        while(value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)){ }
+    }
+
+    static void StoreMax(std::atomic<int>& target, int value){
+        int current = target.load(std::memory_order_relaxed);
+        while(value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)){ }
+    }
+
+    std::atomic<int> left;
+    std::atomic<int> top;
+    std::atomic<int> right;
+    std::atomic<int> bottom;
+};
+
+// Fixed-size square of the world that tracks which of its cells need updating.
+// A chunk whose dirty rect is empty is asleep and skipped by Engine::UpdateTiles.
+// Neighbouring chunks may be marked from several threads during a parallel update, hence the atomic rects.
+struct Chunk{
+
+    Chunk() : x(0), y(0), width(0), height(0){ }
+
+    void SetBounds(int xIn, int yIn, int widthIn, int heightIn){
+        x      = xIn;
+        y      = yIn;
+        width  = widthIn;
+        height = heightIn;
+    }
+
+    // Grows next tick's dirty rect by the part of the given rect that lies inside this chunk.
+    void MarkDirty(int leftIn, int topIn, int rightIn, int bottomIn){
+        nextDirty.Expand(std::max(leftIn, x), std::max(topIn, y), std::min(rightIn, x + width - 1), std::min(bottomIn, y + height - 1));
+    }
+
+    // Promotes the cells touched last tick to the set updated this tick.
+    void BeginTick(){
+        dirty = nextDirty.Load();
+        nextDirty.Clear();
+    }
+
+    bool IsAwake() const{
+        return !dirty.IsEmpty();
+    }
+
+    // Records that the cell at x, y may look different now, so the renderer has to redraw it.
+    void MarkChanged(int xIn, int yIn){
+        changed.Expand(xIn, yIn, xIn, yIn);
+    }
+
+    // Same as above for the part of the given rect that lies inside this chunk.
+    void MarkChanged(int leftIn, int topIn, int rightIn, int bottomIn){
+        changed.Expand(std::max(leftIn, x), std::max(topIn, y), std::min(rightIn, x + width - 1), std::min(bottomIn, y + height - 1));
+    }
+
+    // Returns the cells changed since the last call and starts collecting afresh.
+    DirtyRect TakeChanged(){
+        const DirtyRect rect = changed.Load();
+        changed.Clear();
+        return rect;
+    }
+
+    int x;
+    int y;
+    int width;
+    int height;
+    DirtyRect       dirty;     // Cells to update this tick
+    AtomicDirtyRect nextDirty; // Cells touched this tick, updated on the next one
+    AtomicDirtyRect changed;   // Cells written since the renderer last asked, independent of ticks
+};
+
+#endif // CHUNK_H
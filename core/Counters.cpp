@@ -0,0 +1,69 @@
+#include "Counters.h"
+#include <QStringList>
+
+namespace {
+
+    const char* const CounterNames[Counters::CounterCount] = {
+        "cells_visited",
+        "cells_updated",
+        "gravity_swaps",
+        "gravity_distance",
+        "spread_swaps",
+        "flow_swaps",
+        "flow_cells_scanned",
+        "burning_cells",
+        "phase_changes",
+    };
+
+    const char* const PhaseNames[Counters::PhaseCount] = {
+        "prepare_ms",
+        "row_kernels_ms",
+        "cell_pass_ms",
+        "fire_ms",
+        "heat_ms",
+        "record_ms",
+        "tick_ms",
+    };
+
+}
+
+// Whether the core was built with PPE_ENABLE_COUNTERS.
+bool Counters::Enabled(){
+#ifdef PPE_ENABLE_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* Counters::Name(Counter counter){
+    return CounterNames[counter];
+}
+
+const char* Counters::Name(Phase phase){
+    return PhaseNames[phase];
+}
+
+// One CSV line naming the columns CsvRow writes.
+QString Counters::CsvHeader(){
+    QStringList columns("tick");
+    for(const char* name : CounterNames){
+        columns.append(name);
+    }
+    for(const char* name : PhaseNames){
+        columns.append(name);
+    }
+    return columns.join(',');
+}
+
+// One CSV line of counters.
+QString Counters::CsvRow(const TickCounters& counters){
+    QStringList columns(QString::number(counters.tick));
+    for(qint64 count : counters.counts){
+        columns.append(QString::number(count));
+    }
+    for(double milliseconds : counters.phaseMilliseconds){
+        columns.append(QString::number(milliseconds, 'f', 3));
+    }
+    return columns.join(',');
+}
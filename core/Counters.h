@@ -0,0 +1,77 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Per tick instrumentation of where the engine's time goes. Counting only happens in a core built with
+// PPE_ENABLE_COUNTERS defined (qmake CONFIG+=counters); otherwise every PPE_COUNT compiles to nothing and
+// Engine::LastTickCounters stays all zero.
+namespace Counters{
+
+    enum Counter{
+        CELLS_VISITED = 0,  // Cells inside the dirty rects of the chunks updated
+        CELLS_UPDATED,      // Non-empty cells the per-cell pass updated, plus those a powder row kernel moved
+        GRAVITY_SWAPS,      // Straight falls and rises, by GravityUpdate or a powder row kernel
+        GRAVITY_DISTANCE,   // Rows those straight moves covered, more than one a swap for cells falling freely
+        SPREAD_SWAPS,       // Diagonal and sideways steps, by SpreadUpdate or a powder row kernel
+        FLOW_SWAPS,         // Long range liquid moves along a row, by FlowUpdate
+        FLOW_CELLS_SCANNED, // Cells FlowUpdate searched along rows for somewhere to flow to
+        BURNING_CELLS,      // Cells on fire at the end of the tick
+        PHASE_CHANGES,      // Cells that melted, froze, boiled or condensed
+        CounterCount
+    };
+
+    enum Phase{
+        PREPARE = 0,  // Wall time waking chunks before the update
+        ROW_KERNELS,  // Time in powder row kernels, summed over every chunk and thread
+        CELL_PASS,    // Time in the per-cell pass, summed over every chunk and thread
+        FIRE,         // Wall time of the combustion pass
+        HEAT,         // Wall time of the heat diffusion pass and the phase changes it finds
+        RECORD,       // Wall time the attached Recorder took
+        TICK,         // Wall time of the whole tick
+        PhaseCount
+    };
+
+    // Whether the core was built with PPE_ENABLE_COUNTERS.
+    bool Enabled();
+
+    // Short snake_case names, as used for CSV columns.
+    const char* Name(Counter counter);
+    const char* Name(Phase phase);
+
+}
+
+// What the counters added up to over one tick.
+struct TickCounters{
+    quint64 tick = 0;                                       // Tick count after the tick
+    qint64  counts[Counters::CounterCount] = {};
+    double  phaseMilliseconds[Counters::PhaseCount] = {};
+};
+
+namespace Counters{
+
+    // One CSV line naming the columns CsvRow writes, without a line break.
+    QString CsvHeader();
+
+    // One CSV line of counters, without a line break.
+    QString CsvRow(const TickCounters& counters);
+
+}
+
+// Counts and nanoseconds gathered by one chunk's update, added to the tick's totals once the chunk is done.
+struct ChunkCounters{
+    qint64 counts[Counters::CounterCount] = {};
+    qint64 phaseNanoseconds[Counters::PhaseCount] = {};
+};
+
+// Adds amount to counter in the UpdateContext's ChunkCounters. Nothing, not even amount, is evaluated without
+// PPE_ENABLE_COUNTERS. Hot loops add up in locals and count once a row or chunk: the context is a store to memory
+// that every call the loop makes forces out of registers.
+#ifdef PPE_ENABLE_COUNTERS
+#define PPE_COUNT(context, counter, amount) ( (context).counters.counts[Counters::counter] += (amount) )
+#else
+#define PPE_COUNT(context, counter, amount) static_cast<void>(0)
+#endif
+
+#endif // COUNTERS_H
@@ -0,0 +1,300 @@
+#include "Elements.h"
+#include "Engine.h"
+#include "CellGrid.h"
+#include "Occupancy.h"
+#include "UpdateContext.h"
+#include <QObject>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <utility>
+
+#include <QDebug>
+
+// Returns the CellFlag heading bits for a move, keeping only the horizontal component.
+quint8 HeadingFromPointChange(const QPoint& initialPoint, const QPoint& endPoint)
+{
+    if(initialPoint.x() < endPoint.x()){ // -> moved right
+        return CellFlag::HEADING_RIGHT;
+    }else if(initialPoint.x() > endPoint.x()){ // -> moved left
+        return CellFlag::HEADING_LEFT;
+    }
+    return 0;
+}
+
+// Records the heading of the cell at initialPoint before it is swapped to endPoint.
+void SetHeading(CellGrid& cells, const QPoint& initialPoint, const QPoint& endPoint){
+    quint8& flags = cells.flags[cells.Index(initialPoint.x(), initialPoint.y())];
+    flags = ( flags & ~CellFlag::HEADING_MASK ) | HeadingFromPointChange(initialPoint, endPoint);
+}
+
+// Keeps the vertical speed of a cell in step with a spread from initialPoint to endPoint. A diagonal step down has it
+// falling at least a cell per tick, one up rising at least a cell per tick, and a sideways step leaves it as it was,
+// so a cell that drifts sideways as it falls keeps its speed.
+void DeltaVelocityDueToGravity(qint8& velocity, const QPoint& initialPoint, const QPoint& endPoint){
+    if(endPoint.y() > initialPoint.y()){ // -> moved down
+        velocity = std::min<qint8>(velocity, -1);
+    }else if(endPoint.y() < initialPoint.y()){ // -> moved up
+        velocity = std::max<qint8>(velocity, 1);
+    }
+}
+
+// Returns the row a cell at x, y falling speed cells this tick ends the tick on, searching its column a word of
+// the column occupancy bits at a time. The cell below must be empty and inside the context's reach.
+int FallDestination(UpdateContext& context, int xPos, int yPos, int speed){
+    const int lowest   = std::min(yPos + speed, context.reach.bottom());
+    const int obstacle = context.engine->RowOccupancy().FindNearestInColumn(true, xPos, yPos + 1, lowest);
+    return obstacle >= 0 ? obstacle - 1 : lowest;
+}
+
+// True is left, false is right. Cells without a heading pick one at random.
+bool HorizontalDirectionFromHeading(quint8 flags, Random& random){
+    switch(flags & CellFlag::HEADING_MASK){
+        case CellFlag::HEADING_LEFT:  return true;
+        case CellFlag::HEADING_RIGHT: return false;
+        default:                      return random.NextBool();
+    }
+}
+
+// Whether a material of Density moving with gravity trades places with a cell of otherDensity: materials denser than
+// air sink through anything lighter, and lighter ones rise through anything heavier short of a solid.
+template<quint8 Density>
+constexpr bool Displaces(quint8 otherDensity){
+    if constexpr (Density > Mat::AIR_DENSITY){
+        return otherDensity < Density;
+    }else{
+        return otherDensity > Density && otherDensity <= Mat::MaxLiquidDensity;
+    }
+}
+
+// Moves the cell with gravity if it is denser than air, or one step against it if it is lighter.
+// Falling into an empty cell it carries on down to its FallDestination in the same swap, a cell per tick faster
+// every tick it keeps falling. Anything else it sinks through it crosses a cell at a time.
+// Returns how many rows it moved, 0 if it stayed put.
+template<quint8 Density>
+int GravityUpdate(UpdateContext& context, QPoint& position){
+    Engine* engine = context.engine;
+    CellGrid& cells = engine->Cells();
+    const int index = cells.Index(position.x(), position.y());
+    int distance = 0;
+
+    // a positive y implies gravity down, because it's so more dense than air.
+    // a negative y implies gravity up, because it's less dense than air.
+    constexpr int yDirection = Density == Mat::AIR_DENSITY ? 0 : ( Density > Mat::AIR_DENSITY ? 1 : -1 );
+
+    QPoint gravitatedPoint(position.x(), position.y() + yDirection);
+    if(engine->InBounds(gravitatedPoint) && Displaces<Density>(engine->DensityAt(gravitatedPoint))){
+
+        SetHeading(cells, position, gravitatedPoint);
+
+        if constexpr (Density > Mat::AIR_DENSITY){
+            qint8& velocity = cells.velocity[index];
+            if(engine->IsEmpty(gravitatedPoint)){
+                const int speed = FallSpeed(velocity);
+                gravitatedPoint.setY(FallDestination(context, position.x(), position.y(), speed));
+                velocity = static_cast<qint8>(-speed);
+            }else{
+                velocity = -1;
+            }
+        }
+
+        engine->Swap(position, gravitatedPoint);
+        distance = std::abs(gravitatedPoint.y() - position.y());
+        position = gravitatedPoint;
+    }else if constexpr (Density > Mat::AIR_DENSITY){
+        // Landed, losing whatever speed it fell at.
+        if(cells.velocity[index] != 0){
+            cells.velocity[index] = 0;
+            engine->TouchCell(index);
+        }
+    }
+    return distance;
+}
+
+// Slides the cell diagonally down into empty or less dense cells, and sideways into empty cells if Sideways is set.
+// Materials lighter than air mirror this: bottom means top, and they slide into anything they Displace.
+template<quint8 Density, bool Sideways>
+bool SpreadUpdate(UpdateContext& context, QPoint& position){
+    Engine* engine = context.engine;
+    constexpr int yDirection = Density > Mat::AIR_DENSITY ? 1 : -1;
+
+    bool spread = true;
+    int x = position.x();
+    int y = position.y();
+    CellGrid& cells = engine->Cells();
+    const int index = cells.Index(x, y);
+    QPoint spreadPoint;
+
+    bool canSpreadLeft                    = engine->IsEmpty(x - 1, y);
+    bool canSpreadRight                   = engine->IsEmpty(x + 1, y);
+    bool canSpreadBottomLeft              = engine->IsEmpty(x - 1, y + yDirection) && canSpreadLeft;
+    bool canSpreadBottomRight             = engine->IsEmpty(x + 1, y + yDirection) && canSpreadRight;
+    bool canSpreadBottomLeftDueToDensity  = Displaces<Density>(engine->DensityAt(x - 1, y + yDirection)) && canSpreadLeft;
+    bool canSpreadBottomRightDueToDensity = Displaces<Density>(engine->DensityAt(x + 1, y + yDirection)) && canSpreadRight;
+
+    if (canSpreadBottomLeft && canSpreadBottomRight) { // bottom right or bottom left based on heading
+        bool left = HorizontalDirectionFromHeading(cells.flags[index], context.random);
+        spreadPoint = left ? QPoint(x - 1, y + yDirection) : QPoint(x + 1, y + yDirection);
+    } else if (canSpreadBottomLeft) { // bottom left
+        spreadPoint = QPoint(x - 1, y + yDirection);
+    } else if (canSpreadBottomRight) { // bottom right
+        spreadPoint = QPoint(x + 1, y + yDirection);
+    } else if (canSpreadBottomLeftDueToDensity && canSpreadBottomRightDueToDensity) { // bottom right or left based on heading (against delta density)
+        bool left = HorizontalDirectionFromHeading(cells.flags[index], context.random);
+        spreadPoint = left ? QPoint(x - 1, y + yDirection) : QPoint(x + 1, y + yDirection);
+    } else if (canSpreadBottomLeftDueToDensity) { // bottom left (less dense)
+        spreadPoint = QPoint(x - 1, y + yDirection);
+    } else if (canSpreadBottomRightDueToDensity) { // bottom right (less dense)
+        spreadPoint = QPoint(x + 1, y + yDirection);
+    } else if (Sideways && canSpreadLeft && canSpreadRight) { // right or left based on heading
+        bool left = HorizontalDirectionFromHeading(cells.flags[index], context.random);
+        spreadPoint = left ? QPoint(x - 1, y) : QPoint(x + 1, y);
+    } else if (Sideways && canSpreadLeft) { // left
+        spreadPoint = QPoint(x - 1, y);
+    } else if (Sideways && canSpreadRight) { // right
+        spreadPoint = QPoint(x + 1, y);
+    }
+    else{
+        spread = false;
+    }
+
+    if(spread){
+        SetHeading(cells, position, spreadPoint);
+        DeltaVelocityDueToGravity(cells.velocity[index], position, spreadPoint);
+        engine->Swap(position, spreadPoint);
+        position = spreadPoint;
+    }
+
+    return spread;
+}
+
+// Long range spread along the row, used once a liquid can neither fall nor spread locally.
+template<quint8 Density>
+bool FlowUpdate(UpdateContext& context, QPoint& position){
+    Engine* engine = context.engine;
+    CellGrid& cells = engine->Cells();
+    const int index = cells.Index(position.x(), position.y());
+
+    // Don't look for a spot along the row if every neighbour is occupied. Most liquid cells are buried in their body
+    // and this costs them eight reads instead of the searches below. Only cells at a surface flow, so a buried cell
+    // stays put even where the row has room further along.
+    bool isSurrounded = true;
+    for(int i = -1; i <= 1 && isSurrounded; ++i){
+        for(int j = -1; j <= 1; ++j){
+            if(engine->IsEmpty(position.x() + i, position.y() + j)){
+                isSurrounded = false;
+                break;
+            }
+        }
+    }
+
+    if(isSurrounded){
+        if(cells.flags[index] & CellFlag::HEADING_MASK){
+            cells.flags[index] &= ~CellFlag::HEADING_MASK;
+            engine->TouchCell(index);
+        }
+        return false;
+    }
+
+    // Should compound the liquid's heading in its already moving direction
+    int spreadDirection = HorizontalDirectionFromHeading(cells.flags[index], context.random) ? -1 : 1;
+
+    // Flow to the nearest empty cell along the row, unless something denser stops us first.
+    // Both searches go a word of the row occupancy bitsets at a time instead of a cell at a time.
+    // The search never leaves the context's reach so parallel chunks cannot collide.
+    QPoint spreadPoint(position);
+    const Occupancy& occupancy = engine->RowOccupancy();
+    const int y     = position.y();
+    const int from  = position.x() + spreadDirection;
+    const int limit = spreadDirection > 0 ? context.reach.right() : context.reach.left();
+    if(context.reach.contains(from, y)){
+        int emptyX = occupancy.FindNearest(Occupancy::OCCUPIED, false, y, from, limit);
+        if(emptyX >= 0 && occupancy.FindNearest(Occupancy::SOLID, true, y, from, emptyX) >= 0){
+            emptyX = -1;
+        }
+        if constexpr (Density < Mat::MaxLiquidDensity){
+            // Heavier liquids also stop lighter ones but are not SOLID, so check the cells we would flow through.
+            for(int x = from; emptyX >= 0 && x != emptyX; x += spreadDirection){
+                if(engine->DensityAt(x, y) > Density){
+                    emptyX = -1;
+                }
+            }
+        }
+        if(emptyX >= 0){
+            spreadPoint = QPoint(emptyX, y);
+        }
+        PPE_COUNT(context, FLOW_CELLS_SCANNED, std::abs(( emptyX >= 0 ? emptyX : limit ) - from) + 1);
+    }
+
+    if(cells.flags[index] & CellFlag::HEADING_MASK){
+        cells.flags[index] &= ~CellFlag::HEADING_MASK;
+        engine->TouchCell(index);
+    }
+
+    if(spreadPoint != position){
+        engine->Swap(position, spreadPoint);
+        position = spreadPoint;
+        return true;
+    }
+
+    return false;
+}
+
+// The update kernel for one material, with every trait resolved at compile time.
+template<Mat::Material M>
+CellMoves UpdateMaterial(UpdateContext& context, QPoint& position){
+    constexpr Mat::Traits traits = Mat::TraitsOf(M);
+    static_assert(traits.material == M, "Mat::MaterialTraits must be ordered by material id");
+
+    CellMoves moves;
+    if constexpr (traits.movement == Mat::Movement::POWDER){
+        moves.gravityDistance = GravityUpdate<traits.density>(context, position);
+        if constexpr (traits.friction < 0.5){
+            moves.spread = SpreadUpdate<traits.density, false>(context, position);
+        }
+    }else if constexpr (traits.movement == Mat::Movement::LIQUID){
+        moves.gravityDistance = GravityUpdate<traits.density>(context, position);
+        moves.spread          = SpreadUpdate<traits.density, true>(context, position);
+        if(moves.gravityDistance == 0 && !moves.spread){
+            moves.flowed = FlowUpdate<traits.density>(context, position);
+        }
+    }else if constexpr (traits.movement == Mat::Movement::GAS){
+        if constexpr (traits.lifetime > 0){
+            if(context.random.Bounded(traits.lifetime) == 0){
+                context.engine->SetTile(Tile(position, Mat::Material::EMPTY));
+                return moves;
+            }
+        }
+        moves.gravityDistance = GravityUpdate<traits.density>(context, position);
+        moves.spread          = SpreadUpdate<traits.density, true>(context, position);
+        if constexpr (traits.lifetime > 0){
+            if(moves.gravityDistance == 0 && !moves.spread){
+                // Trapped gas keeps its chunk awake, or it would never get the chance to vanish.
+                context.engine->MarkDirty(position.x(), position.y());
+            }
+        }
+    }else{
+        Q_UNUSED(context);
+        Q_UNUSED(position);
+    }
+    return moves;
+}
+
+namespace{
+
+    using UpdateFunction = CellMoves (*)(UpdateContext&, QPoint&);
+
+    template<size_t... Materials>
+    constexpr std::array<UpdateFunction, sizeof...(Materials)> MakeUpdateTable(std::index_sequence<Materials...>){
+        return { { &UpdateMaterial<static_cast<Mat::Material>(Materials)>... } };
+    }
+
+    // One kernel per material, indexed by Mat::Material.
+    constexpr std::array<UpdateFunction, Mat::MaterialCount> UpdateTable = MakeUpdateTable(std::make_index_sequence<Mat::MaterialCount>());
+
+}
+
+// Runs the material's update kernel for the cell at position. position follows the cell if it moves.
+CellMoves UpdateCell(UpdateContext& context, QPoint& position, Mat::Material material){
+    return UpdateTable[material](context, position);
+}
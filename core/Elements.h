@@ -0,0 +1,168 @@
+#ifndef ELEMENTS_H
+#define ELEMENTS_H
+
+#include <QMetaEnum>
+#include <QPoint>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#define AMBIENT_TEMP     20.0  // Celsius
+#define DEFAULT_LIFETIME 60    // Ticks, about 3.6 seconds at the default tick rate
+
+class CellGrid;
+struct UpdateContext;
+
+namespace Mat{
+    Q_NAMESPACE
+    // Material ids are stored as a byte per cell and index MaterialTraits, so keep them dense and in table order.
+    enum Material{
+        EMPTY = 0,
+        SAND  = 1,
+        WATER = 2,
+        WOOD  = 3,
+        SMOKE = 4,
+        ICE   = 5,
+        STEAM = 6,
+    };
+    Q_ENUM_NS(Material)
+
+    // Densities are ranked into a byte per cell so the rules can compare neighbours without looking up their material.
+    // Anything ranked above AIR_DENSITY falls, anything ranked below it rises.
+    enum DensityClass : quint8{
+        SMOKE_DENSITY  = 0x20, // ~0.6 kg/m^3, hot combustion gases
+        STEAM_DENSITY  = 0x30, // 0.6 kg/m^3 at 100 C, ranked above smoke so smoke rises through it
+        AIR_DENSITY    = 0x40, // ~1.225 kg/m^3, also what EMPTY cells hold
+        WATER_DENSITY  = 0xA0, // 997 kg/m^3
+        SAND_DENSITY   = 0xC0, // 1520 kg/m^3
+        STATIC_DENSITY = 0xFF, // Immovable solids and anything out of bounds
+    };
+
+    // Selects which update kernel a material runs every tick.
+    enum class Movement : quint8{
+        NONE,   // Never updated
+        STATIC, // Holds its position
+        POWDER, // Falls, then slides diagonally unless friction holds it
+        LIQUID, // Falls, spreads diagonally and sideways, then flows along the row
+        GAS,    // Rises, otherwise spreads diagonally up and sideways, and vanishes after its lifetime
+    };
+
+    // Limit of a material that never changes phase on that side.
+    inline constexpr float Unbounded = std::numeric_limits<float>::infinity();
+
+    // Everything the engine knows about a material. Adding a material means adding an enum value and one entry below.
+    struct Traits{
+        Material material;
+        quint8   density;      // DensityClass
+        double   friction;     // Powders with friction below 0.5 slide diagonally
+        Movement movement;
+        quint32  color;        // 0xAARRGGBB
+        float    conductivity; // Heat passed to an edge neighbour per tick and degree of difference, see Heat.h
+        float    heatCapacity; // Heat that warms the cell by one degree. At least 4 x conductivity, or diffusion oscillates
+        quint16  lifetime;     // Gases: average ticks a cell lasts before it vanishes. 0 lasts forever
+        quint8   burnTicks;    // Ticks a burning cell lasts, see Fire.h. 0 never burns
+        float    ignitionTemperature; // A burning neighbour sets a flammable cell alight once it is this hot
+        float    temperature;  // Celsius a freshly placed cell starts at
+        Material colderPhase;  // What the cell turns into once it cools below lowerLimit Celsius
+        float    lowerLimit;   // -Unbounded if it never does
+        Material hotterPhase;  // What the cell turns into once it heats above upperLimit Celsius
+        float    upperLimit;   // Unbounded if it never does
+    };
+
+    inline constexpr Traits MaterialTraits[] = {
+        // material         density          friction  movement            color       conductivity  heatCapacity  lifetime          burnTicks  ignitionTemperature  temperature    colderPhase      lowerLimit   hotterPhase      upperLimit
+        {  Material::EMPTY, AIR_DENSITY,     0.0,      Movement::NONE,     0xFF404040, 0.10f,        1.0f,         0,                0,         0.0f,                AMBIENT_TEMP,  Material::EMPTY, -Unbounded,  Material::EMPTY, Unbounded  },
+        {  Material::SAND,  SAND_DENSITY,    0.0,      Movement::POWDER,   0xFFBDB76B, 0.30f,        2.0f,         0,                0,         0.0f,                AMBIENT_TEMP,  Material::SAND,  -Unbounded,  Material::SAND,  Unbounded  },
+        {  Material::WATER, WATER_DENSITY,   0.0,      Movement::LIQUID,   0xFF0000FF, 0.50f,        4.0f,         0,                0,         0.0f,                AMBIENT_TEMP,  Material::ICE,   0.0f,        Material::STEAM, 100.0f     },
+        {  Material::WOOD,  STATIC_DENSITY,  1.0,      Movement::STATIC,   0xFF371900, 0.10f,        2.0f,         0,                120,       250.0f,              AMBIENT_TEMP,  Material::WOOD,  -Unbounded,  Material::WOOD,  Unbounded  },
+        {  Material::SMOKE, SMOKE_DENSITY,   0.0,      Movement::GAS,      0xFF6E6A66, 0.05f,        1.0f,         DEFAULT_LIFETIME, 0,         0.0f,                AMBIENT_TEMP,  Material::SMOKE, -Unbounded,  Material::SMOKE, Unbounded  },
+        {  Material::ICE,   STATIC_DENSITY,  1.0,      Movement::STATIC,   0xFFA5F2F3, 0.40f,        2.0f,         0,                0,         0.0f,                -20.0f,        Material::ICE,   -Unbounded,  Material::WATER, 0.0f       },
+        {  Material::STEAM, STEAM_DENSITY,   0.0,      Movement::GAS,      0xFFD8E0E8, 0.05f,        1.0f,         0,                0,         0.0f,                120.0f,        Material::WATER, 95.0f,       Material::STEAM, Unbounded  },
+    };
+
+    inline constexpr int MaterialCount = sizeof(MaterialTraits) / sizeof(MaterialTraits[0]);
+
+    // A cell that has just changed phase must sit inside the limits of what it became, or it would flip back and forth.
+    static_assert([]{
+        for(const Traits& traits : MaterialTraits){
+            const Traits& colder = MaterialTraits[traits.colderPhase];
+            const Traits& hotter = MaterialTraits[traits.hotterPhase];
+            if(traits.lowerLimit > traits.upperLimit
+               || ( traits.lowerLimit > -Unbounded && traits.lowerLimit > colder.upperLimit )
+               || ( traits.upperLimit <  Unbounded && traits.upperLimit < hotter.lowerLimit )){
+                return false;
+            }
+        }
+        return true;
+    }(), "phase limits must overlap so a changed cell stays changed");
+
+    constexpr const Traits& TraitsOf(Material material){
+        return MaterialTraits[material];
+    }
+
+    // Materials moved a whole row at a time by UpdatePowderRow when Engine::RowKernels is on, instead of by UpdateCell.
+    constexpr bool UsesRowKernel(Material material){
+        return TraitsOf(material).movement == Movement::POWDER;
+    }
+
+    // Density of the heaviest liquid. Anything denser stops every liquid, which is what Occupancy::SOLID records.
+    inline constexpr quint8 MaxLiquidDensity = []{
+        quint8 density = AIR_DENSITY;
+        for(const Traits& traits : MaterialTraits){
+            if(traits.movement == Movement::LIQUID && traits.density > density){
+                density = traits.density;
+            }
+        }
+        return density;
+    }();
+
+    // Just the colors of MaterialTraits, indexed by material id, so renderers can map whole rows of ids through a small table.
+    inline constexpr std::array<quint32, MaterialCount> MaterialColors = []{
+        std::array<quint32, MaterialCount> colors{};
+        for(int i = 0; i < MaterialCount; ++i){
+            colors[i] = MaterialTraits[i].color;
+        }
+        return colors;
+    }();
+
+}
+
+// What one cell's update moved it by, for the counters: Engine::UpdateChunk adds these up over a chunk and counts
+// them once, rather than every kernel counting each swap as it makes it.
+struct CellMoves{
+    int  gravityDistance = 0; // Rows a straight fall or rise covered, 0 if it made none
+    bool spread          = false;
+    bool flowed          = false;
+};
+
+// Runs the material's update kernel for the cell at position. position follows the cell if it moves.
+// Dispatches through a table generated from Mat::MaterialTraits, so there is no virtual call per cell.
+CellMoves UpdateCell(UpdateContext& context, QPoint& position, Mat::Material material);
+
+// Fastest a falling cell moves, in cells per tick. Falls are also cut short at the edge of UpdateContext::reach.
+constexpr int MaxFallSpeed = 16;
+
+// Cells per tick a cell falls this tick if nothing is in its way, from its CellGrid::velocity: gravity adds one to
+// the speed it fell at last tick, up to MaxFallSpeed.
+constexpr int FallSpeed(qint8 velocity){
+    return std::clamp(1 - velocity, 1, MaxFallSpeed);
+}
+
+// Returns the row a cell at x, y falling speed cells this tick ends the tick on: the one above the first occupied cell
+// below it, found from the column occupancy bits, but no more than speed rows down and inside the context's reach.
+int FallDestination(UpdateContext& context, int xPos, int yPos, int speed);
+
+// Moves every powder cell of row y between left and right (inclusive): straight down into anything less dense, on down
+// to its FallDestination if that is empty, otherwise a step diagonally down past an empty side cell. Which cells move
+// is decided from byte masks 16 cells at a time, with SSE2 where available. Every cell it touches lies within one
+// cell of the span and the row below it, or further down the column of a cell that falls.
+// Cells already updated or moved this tick, see CellFlag::TICK_PARITY, are skipped and marked dirty for the next one,
+// and the rest are stamped. Returns how many were skipped.
+int UpdatePowderRow(UpdateContext& context, int y, int left, int right);
+
+// Decides the moves of the 16 cells from x on row y for every powder, as UpdatePowderRow would, once one cell at a time
+// and once with SSE2, and returns whether both give the same moves and leave the same flags. The cells and one either
+// side of them must be in the world, with a row below. Leaves the powder cells stamped. Always true without SSE2.
+bool PowderMasksAgree(CellGrid& cells, int x, int y, quint8 parity);
+
+#endif // ELEMENTS_H
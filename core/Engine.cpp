@@ -0,0 +1,1183 @@
+#include "Engine.h"
+#include "Elements.h"
+#include "UpdateContext.h"
+#include <QPoint>
+#include "Fire.h"
+#include "Hashhelpers.h"
+#include "Heat.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <numeric>
+
+namespace{
+
+    // Rows of m_heatScratch per band: temperatures and conductivities of three rows, and 1 / heat capacity
+    // of the lower two.
+    constexpr int HeatScratchRows = 8;
+
+    // Rows' worth of cells each band of DiffuseHeat can queue for a phase change before it gives up and has its
+    // rows searched again by ApplyPhaseChanges.
+    constexpr int PhaseChangeRows = 4;
+
+    // Keeps the fire's draws apart from the chunks' streams, which come from the same seed and tick.
+    constexpr quint64 FireStream = 0x4649524500000000ULL;
+
+    // What the fire draws for the cell at index on the tick with tickKey. It depends on nothing else, so the order
+    // burning cells are listed in never changes the outcome.
+    quint64 FireHash(quint64 tickKey, int index){
+        return Random::Mix(tickKey ^ FireStream ^ static_cast<quint32>(index));
+    }
+
+}
+
+#ifdef PPE_ENABLE_COUNTERS
+namespace{
+
+    using CounterClock = std::chrono::steady_clock;
+
+    qint64 Nanoseconds(CounterClock::duration duration){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    double Milliseconds(CounterClock::duration duration){
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // What the per-cell pass did to one chunk, added up in locals from the CellMoves every update returns and
+    // counted once, so counting costs no stores to memory per swap.
+    struct CellPassTally{
+        qint64 updated         = 0;
+        qint64 gravitySwaps    = 0;
+        qint64 gravityDistance = 0;
+        qint64 spreadSwaps     = 0;
+        qint64 flowSwaps       = 0;
+
+        void Add(const CellMoves& moves){
+            ++updated;
+            gravitySwaps    += moves.gravityDistance != 0;
+            gravityDistance += moves.gravityDistance;
+            spreadSwaps     += moves.spread;
+            flowSwaps       += moves.flowed;
+        }
+
+        void CountInto(UpdateContext& context) const{
+            PPE_COUNT(context, CELLS_UPDATED,    updated);
+            PPE_COUNT(context, GRAVITY_SWAPS,    gravitySwaps);
+            PPE_COUNT(context, GRAVITY_DISTANCE, gravityDistance);
+            PPE_COUNT(context, SPREAD_SWAPS,     spreadSwaps);
+            PPE_COUNT(context, FLOW_SWAPS,       flowSwaps);
+        }
+    };
+
+}
+#endif
+
+Engine::Engine(int width, int height) :
+    m_width(width)
+  , m_height(height)
+  , m_chunkColumns(0)
+  , m_chunkRows(0)
+  , m_activeChunkCount(0)
+  , m_activeCellCount(0)
+  , m_skippedUpdateCount(0)
+  , m_rowKernels(true)
+  , m_seed(DefaultSeed)
+  , m_tickCount(0)
+  , m_tickParity(0)
+  , m_recorder(nullptr)
+  , m_updateRegion()
+  , m_heatActive(false)
+{
+    ResizeTiles(width, height);
+}
+
+// Advances the simulation by the given number of ticks as fast as it can.
+void Engine::Step(int ticks){
+    for(int i = 0; i < ticks; ++i){
+        UpdateTiles();
+    }
+}
+
+// Number of ticks simulated since construction.
+quint64 Engine::TickCount() const{
+    return m_tickCount;
+}
+
+// Restores the tick counter, for example from a snapshot.
+void Engine::SetTickCount(quint64 tickCount){
+    m_tickCount  = tickCount;
+    m_tickParity = ( m_tickCount & 1 ) ? CellFlag::TICK_PARITY : 0;
+    // The cells' stamps may not follow on from the new count, so have the next tick restamp every dirty rect.
+    for(Chunk& chunk : m_chunks){
+        chunk.dirty.Clear();
+    }
+}
+
+int Engine::Width() const{
+    return m_width;
+}
+
+int Engine::Height() const{
+    return m_height;
+}
+
+// Simulates a single tick.
+// Only chunks touched on the previous tick are visited, so settled regions cost nothing.
+void Engine::UpdateTiles(){
+    PPE_TRACE_ZONE("Tick");
+#ifdef PPE_ENABLE_COUNTERS
+    const CounterClock::time_point tickStart = CounterClock::now();
+    for(std::atomic<qint64>& count : m_counts){
+        count.store(0, std::memory_order_relaxed);
+    }
+    for(std::atomic<qint64>& nanoseconds : m_phaseNanoseconds){
+        nanoseconds.store(0, std::memory_order_relaxed);
+    }
+#endif
+
+    m_activeChunkCount = 0;
+    m_activeCellCount  = 0;
+    m_skippedUpdateCount.store(0, std::memory_order_relaxed);
+    // Alternates every tick. Cells placed between ticks carry the previous tick's parity, see SetTile.
+    m_tickParity = ( m_tickCount & 1 ) ? 0 : CellFlag::TICK_PARITY;
+    const QRect area = UpdatedArea();
+    for(Chunk& chunk : m_chunks){
+        if(area.intersects(QRect(chunk.x, chunk.y, chunk.width, chunk.height))){
+            const DirtyRect updated = chunk.dirty;
+            chunk.BeginTick();
+            RestampWoken(chunk.dirty, updated);
+        }else{
+            // Left asleep this tick without losing what it was due to update.
+            chunk.dirty.Clear();
+        }
+        m_activeChunkCount += chunk.IsAwake();
+        m_activeCellCount  += chunk.dirty.Area();
+    }
+#ifdef PPE_ENABLE_COUNTERS
+    const CounterClock::time_point prepared = CounterClock::now();
+#endif
+
+    if(m_workerPool.ThreadCount() > 1){
+        UpdateChunksParallel();
+    }else{
+        UpdateChunksSerial();
+    }
+
+#ifdef PPE_ENABLE_COUNTERS
+    const CounterClock::time_point updated = CounterClock::now();
+#endif
+    Burn(area);
+#ifdef PPE_ENABLE_COUNTERS
+    const CounterClock::time_point burned = CounterClock::now();
+#endif
+    DiffuseHeat(area);
+
+    ++m_tickCount;
+
+#ifdef PPE_ENABLE_COUNTERS
+    const CounterClock::time_point heated = CounterClock::now();
+#endif
+    if(m_recorder != nullptr){
+        PPE_TRACE_ZONE("Record");
+        m_recorder->EndTick(*this);
+    }
+
+#ifdef PPE_ENABLE_COUNTERS
+    const CounterClock::time_point finished = CounterClock::now();
+    m_lastTickCounters.tick = m_tickCount;
+    for(int i = 0; i < Counters::CounterCount; ++i){
+        m_lastTickCounters.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    }
+    m_lastTickCounters.counts[Counters::CELLS_VISITED] = m_activeCellCount;
+    m_lastTickCounters.counts[Counters::BURNING_CELLS] = static_cast<qint64>(m_burning.size());
+    for(int i = 0; i < Counters::PhaseCount; ++i){
+        m_lastTickCounters.phaseMilliseconds[i] = m_phaseNanoseconds[i].load(std::memory_order_relaxed) / 1e6;
+    }
+    m_lastTickCounters.phaseMilliseconds[Counters::PREPARE] = Milliseconds(prepared - tickStart);
+    m_lastTickCounters.phaseMilliseconds[Counters::FIRE]    = Milliseconds(burned - updated);
+    m_lastTickCounters.phaseMilliseconds[Counters::HEAT]    = Milliseconds(heated - burned);
+    m_lastTickCounters.phaseMilliseconds[Counters::RECORD]  = Milliseconds(finished - heated);
+    m_lastTickCounters.phaseMilliseconds[Counters::TICK]    = Milliseconds(finished - tickStart);
+#endif
+}
+
+// Updates every awake chunk in order on the calling thread.
+void Engine::UpdateChunksSerial(){
+    const QRect world(0, 0, m_width, m_height);
+
+    // Bottom chunk rows first so falling cells are not carried into a chunk that has yet to update.
+    for (int chunkY = m_chunkRows - 1; chunkY >= 0; --chunkY) {
+        for (int chunkX = 0; chunkX < m_chunkColumns; ++chunkX) {
+            const Chunk& chunk = m_chunks[chunkY * m_chunkColumns + chunkX];
+            if(chunk.IsAwake()){
+                UpdateChunk(chunk, world);
+            }
+        }
+    }
+}
+
+// Updates awake chunks on the worker pool, one checkerboard phase at a time.
+// Two chunks of the same phase are at least a chunk apart and each stays within ChunkReach of itself,
+// so the cells they touch never overlap and a phase needs no locking.
+void Engine::UpdateChunksParallel(){
+    const QRect world(0, 0, m_width, m_height);
+
+    // Phases are (column parity, row parity counted from the bottom) so the bottom rows go first, like the serial order.
+    static const QPoint phases[] = { QPoint(0, 0), QPoint(1, 0), QPoint(0, 1), QPoint(1, 1) };
+
+    for(const QPoint& phase : phases){
+        m_phaseChunks.clear();
+        for (int rowFromBottom = phase.y(); rowFromBottom < m_chunkRows; rowFromBottom += 2) {
+            const int chunkY = m_chunkRows - 1 - rowFromBottom;
+            for (int chunkX = phase.x(); chunkX < m_chunkColumns; chunkX += 2) {
+                const Chunk& chunk = m_chunks[chunkY * m_chunkColumns + chunkX];
+                if(chunk.IsAwake()){
+                    m_phaseChunks.append(&chunk);
+                }
+            }
+        }
+
+        m_workerPool.Run(m_phaseChunks.size(), [this, &world](int i){
+            const Chunk& chunk = *m_phaseChunks[i];
+            QRect reach = QRect(chunk.x, chunk.y, chunk.width, chunk.height).adjusted(-ChunkReach, -ChunkReach, ChunkReach, ChunkReach);
+            UpdateChunk(chunk, reach.intersected(world));
+        });
+    }
+}
+
+// Updates the cells inside the chunk's dirty rect, never touching cells outside reach.
+// With row kernels on, powders are moved first, a row at a time from the bottom, and skipped by the per-cell pass.
+void Engine::UpdateChunk(const Chunk& chunk, const QRect& reach){
+    PPE_TRACE_ZONE("Chunk");
+    const DirtyRect& rect = chunk.dirty;
+    const int columns = rect.right - rect.left + 1;
+
+    // One stream per chunk and tick, so the numbers a chunk draws do not depend on which thread runs it or when.
+    const int chunkIndex = ( chunk.y / ChunkSize ) * m_chunkColumns + chunk.x / ChunkSize;
+    UpdateContext context(this, reach, Random(Random::Mix(m_seed ^ Random::Mix(m_tickCount)), chunkIndex));
+
+#ifdef PPE_ENABLE_COUNTERS
+    CounterClock::time_point phaseStart = CounterClock::now();
+#endif
+    qint64 skipped = 0;
+    if(m_rowKernels){
+        for (int j = rect.bottom; j >= rect.top; --j) {
+            skipped += UpdatePowderRow(context, j, rect.left, rect.right);
+        }
+    }
+#ifdef PPE_ENABLE_COUNTERS
+    const CounterClock::time_point rowKernelsDone = CounterClock::now();
+    context.counters.phaseNanoseconds[Counters::ROW_KERNELS] += Nanoseconds(rowKernelsDone - phaseStart);
+    phaseStart = rowKernelsDone;
+#endif
+
+    // Visit the columns in a different order every tick so no direction is favoured: start at a random column
+    // and step by a random stride that shares no factor with the column count, which reaches every column once.
+    const int start = context.random.Bounded(columns);
+    int stride = 1 + context.random.Bounded(columns);
+    while(std::gcd(stride, columns) != 1){
+        ++stride;
+    }
+#ifdef PPE_ENABLE_COUNTERS
+    CellPassTally tally;
+#endif
+
+    // Every cell visited is stamped with the tick's parity, and Swap stamps whatever it moves, so a cell carried
+    // into a column or row that is still to come is skipped instead of moving twice in one tick.
+    // Cells the chunk left alone on the last tick were restamped by RestampWoken, so only such repeats are skipped.
+    for (int i = 0, x = rect.left + start; i < columns; ++i, x = rect.left + ( x - rect.left + stride ) % columns) {
+        for (int j = rect.bottom; j >= rect.top; --j) {
+            const int index = m_cells.Index(x, j);
+            Mat::Material material = static_cast<Mat::Material>(m_cells.material[index]);
+            if(material != Mat::Material::EMPTY && !( m_rowKernels && Mat::UsesRowKernel(material) )){
+                if(( m_cells.flags[index] & CellFlag::TICK_PARITY ) == m_tickParity){
+                    MarkDirtyRect(x, j, x, j);
+                    ++skipped;
+                    continue;
+                }
+                StampTick(index);
+                QPoint position(x, j);
+#ifdef PPE_ENABLE_COUNTERS
+                tally.Add(UpdateCell(context, position, material));
+#else
+                UpdateCell(context, position, material);
+#endif
+            }
+        }
+    }
+    if(skipped > 0){
+        m_skippedUpdateCount.fetch_add(skipped, std::memory_order_relaxed);
+    }
+
+#ifdef PPE_ENABLE_COUNTERS
+    tally.CountInto(context);
+    context.counters.phaseNanoseconds[Counters::CELL_PASS] += Nanoseconds(CounterClock::now() - phaseStart);
+    for(int i = 0; i < Counters::CounterCount; ++i){
+        if(context.counters.counts[i] != 0){
+            m_counts[i].fetch_add(context.counters.counts[i], std::memory_order_relaxed);
+        }
+    }
+    for(int i = 0; i < Counters::PhaseCount; ++i){
+        if(context.counters.phaseNanoseconds[i] != 0){
+            m_phaseNanoseconds[i].fetch_add(context.counters.phaseNanoseconds[i], std::memory_order_relaxed);
+        }
+    }
+#endif
+}
+
+// Returns whether the tile is a valid coordinate to check against.
+bool Engine::InBounds(int xPos, int yPos){
+    return xPos >= 0 && xPos < m_width && yPos >= 0 && yPos < m_height;
+}
+
+// Returns whether the tile is a valid coordinate to check against.
+bool Engine::InBounds(const Tile& tile){
+    return InBounds(tile.position);
+}
+
+// Returns whether the tile is a valid coordinate to check against.
+bool Engine::InBounds(const QPoint& position){
+    return InBounds(position.x(), position.y());
+}
+
+// Returns whether the tile at location x, y's material is empty
+bool Engine::IsEmpty(int xPos, int yPos){
+    return InBounds(xPos, yPos) && m_cells.material[m_cells.Index(xPos, yPos)] == Mat::Material::EMPTY;
+}
+
+// Returns whether the tile at location x, y's material is empty
+bool Engine::IsEmpty(const QPoint& position){
+    return IsEmpty(position.x(), position.y());
+}
+
+// Returns whether the tile at location x, y's material is empty
+bool Engine::IsEmpty(const Tile& tile){
+    return tile.material == Mat::Material::EMPTY;
+}
+
+// Returns the density class of the cell at location x, y. Out of bounds reads as an immovable solid.
+quint8 Engine::DensityAt(int xPos, int yPos){
+    return InBounds(xPos, yPos) ? m_cells.density[m_cells.Index(xPos, yPos)] : static_cast<quint8>(Mat::STATIC_DENSITY);
+}
+
+// Returns the density class of the cell at location x, y. Out of bounds reads as an immovable solid.
+quint8 Engine::DensityAt(const QPoint& position){
+    return DensityAt(position.x(), position.y());
+}
+
+// Controls setting tiles at a particular location.
+void Engine::SetTile( const Tile& tile ){
+    if(InBounds(tile)){
+        const quint8 density = Mat::TraitsOf(tile.material).density;
+        const int index = m_cells.Index(tile.position.x(), tile.position.y());
+        m_cells.Set(index, tile.material, density);
+        if(Mat::TraitsOf(tile.material).temperature != static_cast<float>(AMBIENT_TEMP)){
+            m_heatActive.store(true, std::memory_order_relaxed);
+        }
+        StampTick(index);
+        TouchCell(index);
+        m_occupancy.Set(tile.position.x(), tile.position.y(), tile.material != Mat::Material::EMPTY, density > Mat::MaxLiquidDensity);
+        MarkDirty(tile.position.x(), tile.position.y());
+        MarkChanged(tile.position.x(), tile.position.y());
+    }
+}
+
+// Controls setting tiles at a particular location.
+void Engine::SetTile( Tile* tile ){
+    SetTile(*tile);
+}
+
+// Writes material into every cell of rect, clipped to the world, and marks it once.
+void Engine::FillRect(const QRect& rect, Mat::Material material){
+    const QRect clipped = rect.intersected(QRect(0, 0, m_width, m_height));
+    if(clipped.isEmpty()){
+        return;
+    }
+    for(int y = clipped.top(); y <= clipped.bottom(); ++y){
+        FillRow(y, clipped.left(), clipped.right(), material);
+    }
+    MarkRegion(clipped.left(), clipped.top(), clipped.right(), clipped.bottom());
+}
+
+// Writes material into every cell of the spans, clipped to the world, and marks the region they cover once.
+void Engine::FillSpans(const QVector<Span>& spans, Mat::Material material){
+    PPE_TRACE_ZONE("FillSpans");
+    int regionLeft   = m_width;
+    int regionTop    = m_height;
+    int regionRight  = -1;
+    int regionBottom = -1;
+    for(const Span& span : spans){
+        if(span.y < 0 || span.y >= m_height){
+            continue;
+        }
+        const int left  = std::max(span.left, 0);
+        const int right = std::min(span.right, m_width - 1);
+        if(left > right){
+            continue;
+        }
+        FillRow(span.y, left, right, material);
+        regionLeft   = std::min(regionLeft, left);
+        regionTop    = std::min(regionTop, span.y);
+        regionRight  = std::max(regionRight, right);
+        regionBottom = std::max(regionBottom, span.y);
+    }
+
+    if(regionLeft <= regionRight){
+        MarkRegion(regionLeft, regionTop, regionRight, regionBottom);
+    }
+}
+
+// Writes material into the cells of rect whose bit is set in mask, a run of set bits at a time,
+// and marks the part of rect inside the world once.
+void Engine::FillMask(const QRect& rect, const QBitArray& mask, Mat::Material material){
+    const QRect clipped = rect.intersected(QRect(0, 0, m_width, m_height));
+    if(clipped.isEmpty() || mask.size() < rect.width() * rect.height()){
+        return;
+    }
+    for(int y = clipped.top(); y <= clipped.bottom(); ++y){
+        const int rowBit = ( y - rect.top() ) * rect.width() - rect.left();
+        int x = clipped.left();
+        while(x <= clipped.right()){
+            if(!mask.testBit(rowBit + x)){
+                ++x;
+                continue;
+            }
+            const int left = x;
+            while(x <= clipped.right() && mask.testBit(rowBit + x)){
+                ++x;
+            }
+            FillRow(y, left, x - 1, material);
+        }
+    }
+    MarkRegion(clipped.left(), clipped.top(), clipped.right(), clipped.bottom());
+}
+
+// Reallocates the world at the given size. All cells are cleared to EMPTY.
+void Engine::ResizeTiles(int width, int height){
+    m_width  = width;
+    m_height = height;
+    m_cells.Resize(width, height);
+    m_occupancy.Resize(width, height);
+    ResizeChunks();
+    m_heatActive.store(false, std::memory_order_relaxed);
+    m_burning.clear();
+
+    if(m_recorder != nullptr){
+        m_recorder->Reset(m_cells.Count());
+    }
+}
+
+// Resizes the world keeping its cells where they are relative to the edges in anchor.
+void Engine::ResizeKeepingCells(int width, int height, Qt::Alignment anchor){
+    PPE_TRACE_ZONE("Resize");
+    width  = std::max(width,  0);
+    height = std::max(height, 0);
+    if(width == m_width && height == m_height){
+        return;
+    }
+
+    const int shiftX = ( anchor & Qt::AlignRight )  ? width - m_width
+                     : ( anchor & Qt::AlignHCenter ) ? ( width - m_width ) / 2
+                     : 0;
+    const int shiftY = ( anchor & Qt::AlignBottom )  ? height - m_height
+                     : ( anchor & Qt::AlignVCenter ) ? ( height - m_height ) / 2
+                     : 0;
+    const std::vector<DirtyRect> pending = PendingDirtyRects();
+    const QRect kept = QRect(shiftX, shiftY, m_width, m_height).intersected(QRect(0, 0, width, height));
+    const int oldWidth = m_width;
+
+    m_width  = width;
+    m_height = height;
+    m_cells.Resize(width, height, shiftX, shiftY);
+    m_occupancy.Resize(width, height, shiftX, shiftY);
+    ResizeChunks();
+
+    // Burning cells move with the rest, and those cut off are gone.
+    size_t burning = 0;
+    for(const int index : m_burning){
+        const int x = index % oldWidth + shiftX;
+        const int y = index / oldWidth + shiftY;
+        if(x >= 0 && x < width && y >= 0 && y < height){
+            m_burning[burning++] = m_cells.Index(x, y);
+        }
+    }
+    m_burning.resize(burning);
+
+    // Whatever was due for update still is, where it moved to.
+    for(const DirtyRect& rect : pending){
+        if(!rect.IsEmpty()){
+            MarkDirtyRect(rect.left + shiftX, rect.top + shiftY, rect.right + shiftX, rect.bottom + shiftY);
+        }
+    }
+
+    // Wake the new cells, and with them the kept cells along their edge that may now move into them.
+    if(kept.isEmpty()){
+        MarkRegion(0, 0, width - 1, height - 1);
+    }else{
+        if(kept.top() > 0)               MarkRegion(0, 0, width - 1, kept.top() - 1);
+        if(kept.bottom() < height - 1)   MarkRegion(0, kept.bottom() + 1, width - 1, height - 1);
+        if(kept.left() > 0)              MarkRegion(0, kept.top(), kept.left() - 1, kept.bottom());
+        if(kept.right() < width - 1)     MarkRegion(kept.right() + 1, kept.top(), width - 1, kept.bottom());
+    }
+
+    if(m_recorder != nullptr){
+        m_recorder->Reset(m_cells.Count());
+    }
+}
+
+// Convenience for getting a tile at a position.
+Tile Engine::TileAt(int xPos, int yPos){
+    if( !InBounds(xPos, yPos) )
+        return Tile();
+    return Tile(xPos, yPos, static_cast<Mat::Material>(m_cells.material[m_cells.Index(xPos, yPos)]));
+}
+
+// Convenience for getting a tile at a position.
+Tile Engine::TileAt(const QPoint& position){
+    return TileAt(position.x(), position.y());
+}
+
+// Direct access to the cell storage for the element rules and the renderer.
+CellGrid& Engine::Cells(){
+    return m_cells;
+}
+
+const CellGrid& Engine::Cells() const{
+    return m_cells;
+}
+
+// Rebuilds the occupancy bitsets from the cells and wakes and redraws the whole world.
+void Engine::RebuildFromCells(){
+    m_occupancy.Rebuild(m_cells);
+    m_heatActive.store(true, std::memory_order_relaxed);
+    RebuildBurning();
+    for(Chunk& chunk : m_chunks){
+        chunk.dirty.Clear(); // The stamps are whatever was written, see RestampWoken
+    }
+    if(m_cells.Count() > 0){
+        MarkRegion(0, 0, m_width - 1, m_height - 1);
+    }
+    if(m_recorder != nullptr){
+        m_recorder->Reset(m_cells.Count());
+    }
+}
+
+// The cells each chunk will update on the next tick, in chunk order.
+std::vector<DirtyRect> Engine::PendingDirtyRects() const{
+    std::vector<DirtyRect> rects;
+    rects.reserve(m_chunks.size());
+    for(const Chunk& chunk : m_chunks){
+        rects.push_back(chunk.nextDirty.Load());
+    }
+    return rects;
+}
+
+// Replaces the cells each chunk will update on the next tick, one rect per chunk in chunk order.
+void Engine::SetPendingDirtyRects(const std::vector<DirtyRect>& rects){
+    for(size_t i = 0; i < m_chunks.size() && i < rects.size(); ++i){
+        Chunk& chunk = m_chunks[i];
+        chunk.nextDirty.Clear();
+        if(!rects[i].IsEmpty()){
+            chunk.MarkDirty(rects[i].left, rects[i].top, rects[i].right, rects[i].bottom);
+        }
+    }
+}
+
+// Number of chunks the world is divided into.
+int Engine::ChunkCount() const{
+    return static_cast<int>(m_chunks.size());
+}
+
+// Writes every field of the cell at index, keeping occupancy in step and marking it.
+void Engine::WriteCell(int index, quint8 material, quint8 density, float temperature, qint8 velocity, quint8 flags){
+    const int x = index % m_width;
+    const int y = index / m_width;
+    if(( flags & CellFlag::BURNING ) && !( m_cells.flags[index] & CellFlag::BURNING )){
+        m_burning.push_back(index);
+    }
+    m_cells.material[index]    = material;
+    m_cells.density[index]     = density;
+    m_cells.temperature[index] = temperature;
+    if(temperature != static_cast<float>(AMBIENT_TEMP)){
+        m_heatActive.store(true, std::memory_order_relaxed);
+    }
+    m_cells.velocity[index]    = velocity;
+    m_cells.flags[index]       = flags;
+    m_occupancy.Set(x, y, material != Mat::Material::EMPTY, density > Mat::MaxLiquidDensity);
+    TouchCell(index);
+    MarkDirty(x, y);
+    MarkChanged(x, y);
+}
+
+// Attaches the recorder that Swap and SetTile report changed cells to. nullptr detaches it.
+void Engine::SetRecorder(Recorder* recorder){
+    m_recorder = recorder;
+}
+
+// Per-row bitsets of which cells are occupied or solid, and per-column ones of which are occupied.
+const Occupancy& Engine::RowOccupancy() const{
+    return m_occupancy;
+}
+
+// Swaps two cells, marks both and stamps both with the current tick so neither is updated again before the next one.
+void Engine::Swap(int xPos1, int yPos1, int xPos2, int yPos2){
+    if (!InBounds(xPos1, yPos1)) return;
+    if (!InBounds(xPos2, yPos2)) return;
+
+    SwapUnmarked(xPos1, yPos1, xPos2, yPos2);
+    MarkDirty(xPos1, yPos1);
+    MarkDirty(xPos2, yPos2);
+    MarkChanged(xPos1, yPos1);
+    MarkChanged(xPos2, yPos2);
+
+}
+
+// Swaps and stamps two cells that must be in bounds without marking either of them.
+void Engine::SwapUnmarked(int xPos1, int yPos1, int xPos2, int yPos2){
+    const int index1 = m_cells.Index(xPos1, yPos1);
+    const int index2 = m_cells.Index(xPos2, yPos2);
+    m_cells.Swap(index1, index2);
+    StampTick(index1);
+    StampTick(index2);
+    TouchCell(index1);
+    TouchCell(index2);
+    m_occupancy.Swap(xPos1, yPos1, xPos2, yPos2);
+}
+
+// Marks every cell in the inclusive rect changed, and the rect grown by one cell dirty.
+void Engine::MarkRegion(int left, int top, int right, int bottom){
+    MarkDirtyRect(left - 1, top - 1, right + 1, bottom + 1);
+
+    left   = std::max(left, 0);
+    top    = std::max(top, 0);
+    right  = std::min(right,  m_width  - 1);
+    bottom = std::min(bottom, m_height - 1);
+    for(int chunkY = top / ChunkSize; chunkY <= bottom / ChunkSize; ++chunkY){
+        for(int chunkX = left / ChunkSize; chunkX <= right / ChunkSize; ++chunkX){
+            m_chunks[chunkY * m_chunkColumns + chunkX].MarkChanged(left, top, right, bottom);
+        }
+    }
+}
+
+void Engine::Swap(const QPoint& pos1, const QPoint& pos2){
+    Swap(pos1.x(), pos1.y(), pos2.x(), pos2.y());
+}
+
+void Engine::Swap(const Tile& tile1, const Tile& tile2){
+    Swap(tile1.position, tile2.position);
+}
+
+
+// Schedules the cell at x, y and its 8 neighbours for update on the next tick, waking any chunk they fall in.
+void Engine::MarkDirty(int xPos, int yPos){
+    MarkDirtyRect(xPos - 1, yPos - 1, xPos + 1, yPos + 1);
+}
+
+// Conducts heat between neighbouring cells inside area, in bands of HeatBandHeight rows.
+// Every band copies the rows bordering it before any band writes, so each reads its neighbours as they were
+// before the pass however the bands get scheduled.
+void Engine::DiffuseHeat(const QRect& area){
+    static_assert(HeatBandHeight == ChunkSize, "an area made of whole chunks must be made of whole heat bands");
+    if(!m_heatActive.load(std::memory_order_relaxed) || area.isEmpty()){
+        return;
+    }
+    PPE_TRACE_ZONE("Heat");
+
+    const int bandCount = ( m_height + HeatBandHeight - 1 ) / HeatBandHeight;
+    const size_t stride = static_cast<size_t>(m_width) + 2;
+    m_heatHalos.resize(bandCount * 2 * stride);
+    m_heatScratch.resize(bandCount * HeatScratchRows * stride);
+    m_heatDeviations.resize(bandCount);
+    m_phaseChanges.resize(bandCount * PhaseChangeRows * static_cast<size_t>(m_width));
+    m_phaseChangeCounts.assign(bandCount, 0);
+
+    // Only the bands the area covers run. The rest queue nothing and keep their last deviation.
+    const int firstBand = area.top() / HeatBandHeight;
+    const int bands     = area.bottom() / HeatBandHeight - firstBand + 1;
+    m_workerPool.Run(bands, [this, stride, firstBand](int i){
+        const int band = firstBand + i;
+        float* halos = m_heatHalos.data() + band * 2 * stride + 1;
+        const int top    = band * HeatBandHeight;
+        const int bottom = std::min(top + HeatBandHeight, m_height) - 1;
+        CopyTemperatureRow(top - 1, halos);
+        CopyTemperatureRow(bottom + 1, halos + stride);
+    });
+    m_workerPool.Run(bands, [this, stride, firstBand, &area](int i){
+        const int band = firstBand + i;
+        m_heatDeviations[band] = DiffuseHeatBand(band, m_heatHalos.data() + band * 2 * stride + 1, area.left(), area.right());
+    });
+
+    // Cells outside a limited area were not looked at, so they may not have settled.
+    const float deviation = *std::max_element(m_heatDeviations.begin() + firstBand, m_heatDeviations.begin() + firstBand + bands);
+    m_heatActive.store(deviation >= Heat::SettledDelta || area != QRect(0, 0, m_width, m_height), std::memory_order_relaxed);
+    ApplyPhaseChanges(area);
+}
+
+// Turns every cell DiffuseHeat queued into the phase its temperature calls for, band by band in index order,
+// so the outcome does not depend on which thread ran which band. Bands that ran out of room have their part of
+// area searched again.
+void Engine::ApplyPhaseChanges(const QRect& area){
+    const size_t capacity = PhaseChangeRows * static_cast<size_t>(m_width);
+    qint64 changed = 0;
+    for(size_t band = 0; band < m_phaseChangeCounts.size(); ++band){
+        const int count = m_phaseChangeCounts[band];
+        if(count < 0){
+            const int top    = std::max(static_cast<int>(band) * HeatBandHeight, area.top());
+            const int bottom = std::min(( static_cast<int>(band) + 1 ) * HeatBandHeight - 1, area.bottom());
+            for(int y = top; y <= bottom; ++y){
+                for(int index = m_cells.Index(area.left(), y); index <= m_cells.Index(area.right(), y); ++index){
+                    changed += ChangePhase(index);
+                }
+            }
+            continue;
+        }
+        const int* indices = m_phaseChanges.data() + band * capacity;
+        for(int i = 0; i < count; ++i){
+            changed += ChangePhase(indices[i]);
+        }
+    }
+#ifdef PPE_ENABLE_COUNTERS
+    m_counts[Counters::PHASE_CHANGES].fetch_add(changed, std::memory_order_relaxed);
+#else
+    Q_UNUSED(changed);
+#endif
+}
+
+// Turns the cell at index into the colder or hotter phase of its material if its temperature has left the
+// material's limits. It keeps its temperature, but not its speed or heading.
+bool Engine::ChangePhase(int index){
+    const Mat::Traits& traits = Mat::MaterialTraits[m_cells.material[index]];
+    const float temperature = m_cells.temperature[index];
+    const Mat::Material material = temperature < traits.lowerLimit ? traits.colderPhase
+                                 : temperature > traits.upperLimit ? traits.hotterPhase
+                                 : traits.material;
+    if(material == traits.material){
+        return false;
+    }
+    const quint8 density = Mat::TraitsOf(material).density;
+    const int x = index % m_width;
+    const int y = index / m_width;
+    m_cells.material[index] = material;
+    m_cells.density[index]  = density;
+    m_cells.velocity[index] = 0;
+    m_cells.flags[index]   &= CellFlag::TICK_PARITY;
+    m_occupancy.Set(x, y, material != Mat::Material::EMPTY, density > Mat::MaxLiquidDensity);
+    TouchCell(index);
+    MarkDirty(x, y);
+    MarkChanged(x, y);
+    return true;
+}
+
+// Runs DiffuseHeat for the columns from left to right of one band. Three rows of temperatures and material
+// properties roll down the band, so every row is copied and looked up once.
+float Engine::DiffuseHeatBand(int band, const float* halos, int left, int right){
+    const int top    = band * HeatBandHeight;
+    const int bottom = std::min(top + HeatBandHeight, m_height) - 1;
+    const size_t stride = static_cast<size_t>(m_width) + 2;
+    float* scratch = m_heatScratch.data() + band * HeatScratchRows * stride + 1;
+    float* temperatureAbove  = scratch;
+    float* temperature       = scratch + stride;
+    float* temperatureBelow  = scratch + 2 * stride;
+    float* conductivityAbove = scratch + 3 * stride;
+    float* conductivity      = scratch + 4 * stride;
+    float* conductivityBelow = scratch + 5 * stride;
+    float* inverseHeatCapacity      = scratch + 6 * stride;
+    float* inverseHeatCapacityBelow = scratch + 7 * stride;
+
+    // Rows outside the world conduct like the cell next to them, see Heat::EdgeConductivity. Their heat capacity
+    // is never used. Only the columns diffused and the one either side of them are looked up.
+    const int columns = right - left + 1;
+    const int loadLeft  = std::max(left - 1, 0);
+    const int loadCount = std::min(right + 1, m_width - 1) - loadLeft + 1;
+    auto LoadProperties = [this, loadLeft, loadCount](int yPos, float* conductivityRow, float* inverseHeatCapacityRow){
+        conductivityRow[-1] = conductivityRow[m_width] = Heat::EdgeConductivity;
+        if(yPos < 0 || yPos >= m_height){
+            std::fill(conductivityRow + loadLeft, conductivityRow + loadLeft + loadCount, Heat::EdgeConductivity);
+        }else{
+            Heat::LoadProperties(m_cells.material + m_cells.Index(loadLeft, yPos), loadCount,
+                                 conductivityRow + loadLeft, inverseHeatCapacityRow + loadLeft);
+        }
+    };
+
+    // Cells that left their limits are queued for ApplyPhaseChanges, until the band's share of m_phaseChanges
+    // could not take another row.
+    const size_t capacity = PhaseChangeRows * static_cast<size_t>(m_width);
+    int* phaseChanges = m_phaseChanges.data() + band * capacity;
+    int& phaseChangeCount = m_phaseChangeCounts[band];
+    phaseChangeCount = 0;
+
+    std::memcpy(temperatureAbove - 1, halos - 1, stride * sizeof(float));
+    LoadProperties(top - 1, conductivityAbove, inverseHeatCapacityBelow);
+    CopyTemperatureRow(top, temperature);
+    LoadProperties(top, conductivity, inverseHeatCapacity);
+
+    float deviation = 0.0f;
+    for(int y = top; y <= bottom; ++y){
+        if(y < bottom){
+            CopyTemperatureRow(y + 1, temperatureBelow);
+        }else{
+            std::memcpy(temperatureBelow - 1, halos + stride - 1, stride * sizeof(float));
+        }
+        LoadProperties(y + 1, conductivityBelow, inverseHeatCapacityBelow);
+
+        float* out = m_cells.temperature + m_cells.Index(0, y);
+        deviation = std::max(deviation, Heat::DiffuseRow(temperatureAbove + left, temperature + left, temperatureBelow + left,
+                                                         conductivityAbove + left, conductivity + left, conductivityBelow + left,
+                                                         inverseHeatCapacity + left, out + left, columns));
+        if(m_recorder != nullptr){
+            for(int x = left; x <= right; ++x){
+                if(out[x] != temperature[x]){
+                    m_recorder->Touch(m_cells.Index(x, y));
+                }
+            }
+        }
+        if(phaseChangeCount >= 0){
+            if(phaseChangeCount + static_cast<size_t>(columns) > capacity){
+                phaseChangeCount = -1;
+            }else{
+                int* xs = phaseChanges + phaseChangeCount;
+                const int found = Heat::FindPhaseChanges(m_cells.material + m_cells.Index(left, y), out + left, xs, columns);
+                for(int i = 0; i < found; ++i){
+                    xs[i] += m_cells.Index(left, y);
+                }
+                phaseChangeCount += found;
+            }
+        }
+
+        std::swap(temperatureAbove, temperature);
+        std::swap(temperature, temperatureBelow);
+        std::swap(conductivityAbove, conductivity);
+        std::swap(conductivity, conductivityBelow);
+        std::swap(inverseHeatCapacity, inverseHeatCapacityBelow);
+    }
+    return deviation;
+}
+
+// Copies the temperatures of row y, or AMBIENT_TEMP outside the world, into a row padded with AMBIENT_TEMP.
+void Engine::CopyTemperatureRow(int yPos, float* row) const{
+    constexpr float ambient = static_cast<float>(AMBIENT_TEMP);
+    row[-1] = row[m_width] = ambient;
+    if(yPos < 0 || yPos >= m_height){
+        std::fill(row, row + m_width, ambient);
+    }else{
+        std::memcpy(row, m_cells.temperature + m_cells.Index(0, yPos), m_width * sizeof(float));
+    }
+}
+
+// Lays out fresh chunks over the current size, all asleep and all changed.
+void Engine::ResizeChunks(){
+    m_chunkColumns = ( std::max(m_width,  0) + ChunkSize - 1 ) / ChunkSize;
+    m_chunkRows    = ( std::max(m_height, 0) + ChunkSize - 1 ) / ChunkSize;
+    m_chunks = std::vector<Chunk>(m_chunkColumns * m_chunkRows);
+    for(int chunkY = 0; chunkY < m_chunkRows; ++chunkY){
+        for(int chunkX = 0; chunkX < m_chunkColumns; ++chunkX){
+            int x = chunkX * ChunkSize;
+            int y = chunkY * ChunkSize;
+            Chunk& chunk = m_chunks[chunkY * m_chunkColumns + chunkX];
+            chunk.SetBounds(x, y, std::min(ChunkSize, m_width - x), std::min(ChunkSize, m_height - y));
+            // Every cell was just reallocated, so all of it has to be redrawn.
+            chunk.changed.Expand(chunk.x, chunk.y, chunk.x + chunk.width - 1, chunk.y + chunk.height - 1);
+        }
+    }
+}
+
+// Stamps the cells of rect outside updated, the rect its chunk updated on the last tick, with the last tick's parity.
+void Engine::RestampWoken(const DirtyRect& rect, const DirtyRect& updated){
+    if(rect.IsEmpty()){
+        return;
+    }
+    const quint8 previous = m_tickParity ^ CellFlag::TICK_PARITY;
+    auto Restamp = [this, previous](int yPos, int left, int right){
+        quint8* flags = m_cells.flags + m_cells.Index(0, yPos);
+        for(int x = left; x <= right; ++x){
+            flags[x] = ( flags[x] & ~CellFlag::TICK_PARITY ) | previous;
+        }
+    };
+    for(int j = rect.top; j <= rect.bottom; ++j){
+        if(updated.IsEmpty() || j < updated.top || j > updated.bottom){
+            Restamp(j, rect.left, rect.right);
+        }else{
+            Restamp(j, rect.left, std::min(rect.right, updated.left - 1));
+            Restamp(j, std::max(rect.left, updated.right + 1), rect.right);
+        }
+    }
+}
+
+// Grows the dirty rect of every chunk overlapping the inclusive rect, clipped to the world.
+void Engine::MarkDirtyRect(int left, int top, int right, int bottom){
+    left   = std::max(left, 0);
+    top    = std::max(top, 0);
+    right  = std::min(right,  m_width  - 1);
+    bottom = std::min(bottom, m_height - 1);
+
+    for(int chunkY = top / ChunkSize; chunkY <= bottom / ChunkSize; ++chunkY){
+        for(int chunkX = left / ChunkSize; chunkX <= right / ChunkSize; ++chunkX){
+            m_chunks[chunkY * m_chunkColumns + chunkX].MarkDirty(left, top, right, bottom);
+        }
+    }
+}
+
+// Writes material into the cells from left to right inclusive on row y without marking them.
+void Engine::FillRow(int yPos, int left, int right, Mat::Material material){
+    const quint8 density = Mat::TraitsOf(material).density;
+    const int first = m_cells.Index(left, yPos);
+    const int count = right - left + 1;
+    m_cells.Fill(first, count, material, density);
+    if(Mat::TraitsOf(material).temperature != static_cast<float>(AMBIENT_TEMP)){
+        m_heatActive.store(true, std::memory_order_relaxed);
+    }
+    for(int index = first; index < first + count; ++index){
+        StampTick(index);
+        TouchCell(index);
+    }
+    m_occupancy.SetRun(yPos, left, right, material != Mat::Material::EMPTY, density > Mat::MaxLiquidDensity);
+}
+
+// Adds the cell at x, y to the regions returned by TakeChangedRects.
+void Engine::MarkChanged(int xPos, int yPos){
+    m_chunks[( yPos / ChunkSize ) * m_chunkColumns + xPos / ChunkSize].MarkChanged(xPos, yPos);
+}
+
+// Returns the regions of cells written by Swap or SetTile since the last call, at most one per chunk.
+QVector<QRect> Engine::TakeChangedRects(){
+    QVector<QRect> rects;
+    for(Chunk& chunk : m_chunks){
+        const DirtyRect changed = chunk.TakeChanged();
+        if(!changed.IsEmpty()){
+            rects.append(QRect(QPoint(changed.left, changed.top), QPoint(changed.right, changed.bottom)));
+        }
+    }
+    return rects;
+}
+
+// Writes the 0xAARRGGBB color of every cell into a Width() x Height() buffer of 32 bit pixels.
+void Engine::RenderColors(uchar* bits, int bytesPerLine) const{
+    RenderColors(bits, bytesPerLine, QRect(0, 0, m_width, m_height));
+}
+
+// Same as above, but only writes the pixels of the cells inside region.
+void Engine::RenderColors(uchar* bits, int bytesPerLine, const QRect& region) const{
+    const QRect clipped = region.intersected(QRect(0, 0, m_width, m_height));
+    for(int y = clipped.top(); y <= clipped.bottom(); ++y){
+        const quint8* material = m_cells.material + m_cells.Index(0, y);
+        const quint8* flags    = m_cells.flags + m_cells.Index(0, y);
+        quint32* scanline      = reinterpret_cast<quint32*>(bits + static_cast<qsizetype>(y) * bytesPerLine);
+        for(int x = clipped.left(); x <= clipped.right(); ++x){
+            scanline[x] = ( flags[x] & CellFlag::BURNING ) ? Fire::FlameColor : Mat::MaterialColors[material[x]];
+        }
+    }
+}
+
+// Number of chunks that were updated on the last tick.
+int Engine::ActiveChunkCount() const{
+    return m_activeChunkCount;
+}
+
+// Number of cells inside the dirty rects visited on the last tick.
+qint64 Engine::ActiveCellCount() const{
+    return m_activeCellCount;
+}
+
+// Number of cells the last tick did not update because they had already moved during it.
+qint64 Engine::SkippedUpdateCount() const{
+    return m_skippedUpdateCount.load(std::memory_order_relaxed);
+}
+
+// Sets the temperature of every cell of rect, clipped to the world, in degrees Celsius.
+void Engine::SetTemperature(const QRect& rect, float celsius){
+    const QRect clipped = rect.intersected(QRect(0, 0, m_width, m_height));
+    if(clipped.isEmpty()){
+        return;
+    }
+    for(int y = clipped.top(); y <= clipped.bottom(); ++y){
+        const int first = m_cells.Index(clipped.left(), y);
+        std::fill(m_cells.temperature + first, m_cells.temperature + first + clipped.width(), celsius);
+        if(m_recorder != nullptr){
+            for(int index = first; index < first + clipped.width(); ++index){
+                m_recorder->Touch(index);
+            }
+        }
+    }
+    m_heatActive.store(true, std::memory_order_relaxed);
+}
+
+bool Engine::HeatActive() const{
+    return m_heatActive.load(std::memory_order_relaxed);
+}
+
+// Sets alight every flammable cell of rect, clipped to the world, that is not burning already.
+void Engine::Ignite(const QRect& rect){
+    const QRect clipped = rect.intersected(QRect(0, 0, m_width, m_height));
+    if(clipped.isEmpty()){
+        return;
+    }
+    for(int y = clipped.top(); y <= clipped.bottom(); ++y){
+        IgniteRow(y, clipped.left(), clipped.right());
+    }
+}
+
+// Sets alight every flammable cell of the spans, clipped to the world, that is not burning already.
+void Engine::IgniteSpans(const QVector<Span>& spans){
+    for(const Span& span : spans){
+        const int left  = std::max(span.left, 0);
+        const int right = std::min(span.right, m_width - 1);
+        if(span.y >= 0 && span.y < m_height && left <= right){
+            IgniteRow(span.y, left, right);
+        }
+    }
+}
+
+int Engine::BurningCellCount() const{
+    return static_cast<int>(m_burning.size());
+}
+
+// Burns down every cell in m_burning inside area. A cell lit this tick is appended to m_burning and first burns on
+// the next. Every cell decides from its own state, the neighbours it reads are ones no other cell of the pass writes,
+// and its draws come from FireHash, so the outcome is the same whatever order the cells are listed in.
+void Engine::Burn(const QRect& area){
+    if(m_burning.empty()){
+        return;
+    }
+    PPE_TRACE_ZONE("Burn");
+
+    // Edits and replayed cells can list a cell twice. Sorted, the pass also walks the grid in memory order.
+    std::sort(m_burning.begin(), m_burning.end());
+    m_burning.erase(std::unique(m_burning.begin(), m_burning.end()), m_burning.end());
+
+    const quint64 tickKey = Random::Mix(m_seed ^ Random::Mix(m_tickCount));
+    auto Spread = [this, tickKey](int neighbour){
+        const quint8 material = m_cells.material[neighbour];
+        if(Fire::IsFlammable(material) && !( m_cells.flags[neighbour] & CellFlag::BURNING )
+           && m_cells.temperature[neighbour] >= Mat::MaterialTraits[material].ignitionTemperature){
+            IgniteCell(neighbour, FireHash(tickKey, neighbour));
+        }
+    };
+
+    const size_t listed = m_burning.size();
+    size_t kept = 0;
+    for(size_t i = 0; i < listed; ++i){
+        const int index = m_burning[i];
+        if(!( m_cells.flags[index] & CellFlag::BURNING )){
+            continue; // Overwritten since it caught
+        }
+        const int x = index % m_width;
+        const int y = index / m_width;
+        if(!area.contains(x, y)){
+            m_burning[kept++] = index;
+            continue; // Waits, as its chunk does, until it is inside again
+        }
+
+        if(x > area.left())   Spread(index - 1);
+        if(x < area.right())  Spread(index + 1);
+        if(y > area.top())    Spread(index - m_width);
+        if(y < area.bottom()) Spread(index + m_width);
+
+        if(--m_cells.velocity[index] <= 0){
+            SetTile(Tile(x, y, Mat::Material::SMOKE));
+            m_cells.temperature[index] = Fire::FlameTemperature;
+            continue;
+        }
+        m_cells.temperature[index] = Fire::FlameTemperature;
+        TouchCell(index);
+
+        const int above = index - m_width;
+        if(y > area.top() && m_cells.material[above] == Mat::Material::EMPTY && FireHash(tickKey, index) % Fire::SmokeChance == 0){
+            SetTile(Tile(x, y - 1, Mat::Material::SMOKE));
+            m_cells.temperature[above] = Fire::FlameTemperature;
+        }
+        m_burning[kept++] = index;
+    }
+    m_burning.erase(m_burning.begin() + kept, m_burning.begin() + listed);
+    m_heatActive.store(true, std::memory_order_relaxed);
+}
+
+// Sets alight the flammable cells from left to right inclusive on row y that are not burning already.
+void Engine::IgniteRow(int yPos, int left, int right){
+    const quint64 tickKey = Random::Mix(m_seed ^ Random::Mix(m_tickCount));
+    for(int index = m_cells.Index(left, yPos); index <= m_cells.Index(right, yPos); ++index){
+        if(Fire::IsFlammable(m_cells.material[index]) && !( m_cells.flags[index] & CellFlag::BURNING )){
+            IgniteCell(index, FireHash(tickKey, index));
+        }
+    }
+}
+
+// Sets the cell at index alight and adds it to m_burning. It burns for between 3/4 of its material's
+// burnTicks and all of them.
+void Engine::IgniteCell(int index, quint64 key){
+    const quint8 burnTicks = Mat::MaterialTraits[m_cells.material[index]].burnTicks;
+    m_cells.flags[index]   |= CellFlag::BURNING;
+    m_cells.velocity[index] = static_cast<qint8>(burnTicks - key % ( burnTicks / 4 + 1 ));
+    TouchCell(index);
+    MarkChanged(index % m_width, index / m_width);
+    m_burning.push_back(index);
+}
+
+// Lists every cell flagged CellFlag::BURNING afresh.
+void Engine::RebuildBurning(){
+    m_burning.clear();
+    for(int index = 0; index < m_cells.Count(); ++index){
+        if(m_cells.flags[index] & CellFlag::BURNING){
+            m_burning.push_back(index);
+        }
+    }
+}
+
+// What the last tick counted and how long its phases took. All zero without PPE_ENABLE_COUNTERS.
+const TickCounters& Engine::LastTickCounters() const{
+    return m_lastTickCounters;
+}
+
+// Selects how powders are updated: a row at a time by UpdatePowderRow, or per cell through UpdateCell.
+void Engine::SetRowKernels(bool enabled){
+    m_rowKernels = enabled;
+}
+
+bool Engine::RowKernels() const{
+    return m_rowKernels;
+}
+
+// Seeds every random choice the rules make. Two engines with the same seed, thread count and sequence of edits
+// and steps end up with bit-identical worlds.
+void Engine::SetSeed(quint64 seed){
+    m_seed = seed;
+}
+
+quint64 Engine::Seed() const{
+    return m_seed;
+}
+
+// Sets how many threads update chunks. 1 updates serially on the calling thread.
+void Engine::SetThreadCount(int threadCount){
+    m_workerPool.SetThreadCount(threadCount);
+}
+
+// Number of threads updating chunks, including the one calling UpdateTiles.
+int Engine::ThreadCount() const{
+    return m_workerPool.ThreadCount();
+}
+
+// Only updates the chunks overlapping region, and burns and conducts heat only in them. An empty region updates
+// the whole world.
+void Engine::SetUpdateRegion(const QRect& region){
+    m_updateRegion = region;
+}
+
+QRect Engine::UpdateRegion() const{
+    return m_updateRegion;
+}
+
+// The cells of the chunks overlapping the update region, or the whole world without one.
+QRect Engine::UpdatedArea() const{
+    const QRect world(0, 0, m_width, m_height);
+    const QRect region = m_updateRegion.isEmpty() ? world : m_updateRegion.intersected(world);
+    if(region.isEmpty()){
+        return QRect();
+    }
+    const int left   = region.left() / ChunkSize * ChunkSize;
+    const int top    = region.top()  / ChunkSize * ChunkSize;
+    const int right  = ( region.right()  / ChunkSize + 1 ) * ChunkSize - 1;
+    const int bottom = ( region.bottom() / ChunkSize + 1 ) * ChunkSize - 1;
+    return QRect(QPoint(left, top), QPoint(right, bottom)).intersected(world);
+}
@@ -0,0 +1,363 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "Tile.h"
+#include "CellGrid.h"
+#include "Chunk.h"
+#include "Counters.h"
+#include "Occupancy.h"
+#include "Recording.h"
+#include "Span.h"
+#include "WorkerPool.h"
+#include <QVector>
+#include <QBitArray>
+#include <QMetaEnum>
+#include <QPoint>
+#include <QRect>
+#include <QString>
+#include <atomic>
+#include <vector>
+
+template<typename QEnum>
+QString QtEnumToQString (const QEnum value)
+{
+  return QString(QMetaEnum::fromType<QEnum>().valueToKey(value));
+}
+
+// The simulation core. It owns no timer and knows nothing about rendering; callers decide when to Step it
+// and how to present CellGrid, so it runs the same inside the window and on a headless build box.
+class Engine
+{
+
+public:
+
+    // Side length in cells of the square chunks the world is divided into for activity tracking.
+    static constexpr int ChunkSize = 32;
+
+    // How far past its own chunk a cell may move during a parallel update.
+    // Chunks updated at the same time are a full chunk apart, so each may use half of the gap.
+    static constexpr int ChunkReach = ChunkSize / 2;
+
+    // Rows of each band DiffuseHeat hands to a thread. The bands depend only on the world's height, so the heat
+    // pass gives the same result with any number of threads.
+    static constexpr int HeatBandHeight = 32;
+
+    explicit Engine(int width, int height);
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    // Advances the simulation by the given number of ticks as fast as it can.
+    void Step(int ticks = 1);
+
+    // Number of ticks simulated since construction.
+    quint64 TickCount() const;
+
+    // Restores the tick counter, for example from a snapshot. The random streams and tick parity depend on it,
+    // so a seeded run only continues exactly with the tick count it was saved at.
+    void SetTickCount(quint64 tickCount);
+
+    int Width()  const;
+    int Height() const;
+
+    // Reallocates the world at the given size. All cells are cleared to EMPTY.
+    void ResizeTiles(int width, int height);
+
+    // Resizes the world keeping its cells where they are relative to the edges in anchor: Qt::AlignRight keeps the
+    // right edge in place and adds or drops columns on the left, Qt::AlignHCenter on both sides, anything else on the right.
+    // Qt::AlignBottom and Qt::AlignVCenter do the same for rows. Only the new cells are cleared to EMPTY and woken,
+    // and chunks that were awake stay awake.
+    void ResizeKeepingCells(int width, int height, Qt::Alignment anchor = Qt::AlignLeft | Qt::AlignTop);
+
+    // Returns whether the tile is a valid coordinate to check against.
+    bool InBounds(int xPos, int yPos);
+
+    // Returns whether the tile is a valid coordinate to check against.
+    bool InBounds(const QPoint& position);
+
+    // Returns whether the tile is a valid coordinate to check against.
+    bool InBounds(const Tile& tile);
+
+    // Returns whether the tile at location x, y's material is empty.
+    bool IsEmpty(int xPos, int yPos);
+
+    // Returns whether the tile at location x, y's material is empty.
+    bool IsEmpty(const QPoint& position);
+
+    // Returns whether the tile at location x, y's material is empty.
+    bool IsEmpty(const Tile& tile);
+
+    // Returns the density class of the cell at location x, y. Out of bounds reads as an immovable solid.
+    quint8 DensityAt(int xPos, int yPos);
+
+    // Returns the density class of the cell at location x, y. Out of bounds reads as an immovable solid.
+    quint8 DensityAt(const QPoint& position);
+
+    // Controls setting tiles at a particular location. This will add it to the dirty set.
+    void SetTile( const Tile& tile );
+
+    // Controls setting tiles at a particular location. This will add it to the dirty set.
+    void SetTile( Tile* tile );
+
+    // Bulk edits. Each writes material into many cells, clipped to the world, as SetTile would one at a time,
+    // but a row at a time and marking the region they cover once.
+
+    // Writes material into every cell of rect.
+    void FillRect(const QRect& rect, Mat::Material material);
+
+    // Writes material into every cell of the spans.
+    void FillSpans(const QVector<Span>& spans, Mat::Material material);
+
+    // Writes material into the cells of rect whose bit is set in mask, which holds rect.width() x rect.height() bits
+    // row by row from the top left.
+    void FillMask(const QRect& rect, const QBitArray& mask, Mat::Material material);
+
+    // Convenience for getting a tile at a position. Out of bounds positions return an invalid tile.
+    Tile TileAt(int xPos, int yPos);
+
+    // Convenience for getting a tile at a position. Out of bounds positions return an invalid tile.
+    Tile TileAt(const QPoint& position);
+
+    // Direct access to the cell storage for the element rules and the renderer.
+    CellGrid& Cells();
+    const CellGrid& Cells() const;
+
+    // Call after writing Cells() directly instead of through SetTile, as Snapshot::Load does.
+    // Rebuilds the occupancy bitsets from the cells and wakes and redraws the whole world.
+    void RebuildFromCells();
+
+    // The cells each chunk will update on the next tick, in chunk order. Sleeping chunks give an empty rect.
+    // Which chunks sleep affects the outcome, so a snapshot keeps them to continue a run exactly.
+    std::vector<DirtyRect> PendingDirtyRects() const;
+
+    // Replaces the cells each chunk will update on the next tick, one rect per chunk in chunk order.
+    // Rects are clipped to their chunk.
+    void SetPendingDirtyRects(const std::vector<DirtyRect>& rects);
+
+    // Number of chunks the world is divided into.
+    int ChunkCount() const;
+
+    // Writes every field of the cell at index, which must be in bounds, keeping occupancy in step and marking it.
+    // For replaying recorded cells; rules and tools go through Swap and SetTile.
+    void WriteCell(int index, quint8 material, quint8 density, float temperature, qint8 velocity, quint8 flags);
+
+    // Attaches the recorder that Swap and SetTile report changed cells to, and that is told when a tick ends.
+    // Called by Recorder::Start and Recorder::Finish. nullptr detaches it.
+    void SetRecorder(Recorder* recorder);
+
+    // CellFlag::TICK_PARITY of the tick running. Cells carrying it were already updated or moved during it.
+    quint8 TickParity() const{
+        return m_tickParity;
+    }
+
+    // Reports a cell written in place, rather than through Swap or SetTile, to the recorder if there is one.
+    void TouchCell(int index){
+        if(m_recorder != nullptr){
+            m_recorder->Touch(index);
+        }
+    }
+
+    // Per-row bitsets of which cells are occupied or solid, and per-column ones of which are occupied, kept in step
+    // with Cells() by Swap and SetTile.
+    const Occupancy& RowOccupancy() const;
+
+    // Writes the 0xAARRGGBB color of every cell into a Width() x Height() buffer of 32 bit pixels with
+    // bytesPerLine bytes per row, such as the scanlines of a QImage::Format_RGB32 image.
+    void RenderColors(uchar* bits, int bytesPerLine) const;
+
+    // Same as above, but only writes the pixels of the cells inside region.
+    void RenderColors(uchar* bits, int bytesPerLine, const QRect& region) const;
+
+    // Returns the regions of cells written by Swap or SetTile since the last call, at most one per chunk,
+    // and starts collecting afresh. A renderer only needs to redraw these. Call between ticks.
+    QVector<QRect> TakeChangedRects();
+
+    // Swaps two cells, marks both and stamps both with the current tick so neither is updated again before the next one.
+    void Swap(int xPos1, int yPos1, int xPos2, int yPos2);
+    void Swap(const QPoint& pos1, const QPoint& pos2);
+    void Swap(const Tile& tile1, const Tile& tile2);
+
+    // Swaps and stamps two cells that must be in bounds without marking either of them.
+    // For kernels that move many cells at once and then mark everything they touched with one MarkRegion.
+    void SwapUnmarked(int xPos1, int yPos1, int xPos2, int yPos2);
+
+    // Marks every cell in the inclusive rect changed, and the rect grown by one cell dirty.
+    void MarkRegion(int left, int top, int right, int bottom);
+
+    // Schedules the cell at x, y and its 8 neighbours for update on the next tick, waking any chunk they fall in.
+    void MarkDirty(int xPos, int yPos);
+
+    // Adds the cell at x, y to the regions returned by TakeChangedRects.
+    void MarkChanged(int xPos, int yPos);
+
+    // Number of chunks that were updated on the last tick.
+    int ActiveChunkCount() const;
+
+    // Number of cells inside the dirty rects visited on the last tick.
+    qint64 ActiveCellCount() const;
+
+    // Number of cells the last tick did not update because they had already moved during it,
+    // for example water carried sideways into a column that had yet to be visited.
+    qint64 SkippedUpdateCount() const;
+
+    // Selects how powders are updated. Enabled, each chunk first moves its powders a row at a time with UpdatePowderRow,
+    // 16 cells per step, and then updates everything else per cell. Disabled, every cell goes through UpdateCell,
+    // the reference behaviour.
+    void SetRowKernels(bool enabled);
+
+    bool RowKernels() const;
+
+    // Sets the temperature of every cell of rect, clipped to the world, in degrees Celsius. Heat then conducts
+    // through the world every tick until it has evened out with AMBIENT_TEMP, see Heat.h.
+    void SetTemperature(const QRect& rect, float celsius);
+
+    // Whether some cell may still be away from AMBIENT_TEMP, so ticks run the heat pass.
+    bool HeatActive() const;
+
+    // Sets alight every flammable cell of rect, clipped to the world, that is not burning already. The fire then
+    // spreads to flammable neighbours as it heats them, see Fire.h.
+    void Ignite(const QRect& rect);
+
+    // Sets alight every flammable cell of the spans, as Ignite does those of a rect.
+    void IgniteSpans(const QVector<Span>& spans);
+
+    // Number of cells listed as burning, which may still count cells overwritten since the last tick.
+    // Each tick's fire pass costs time in proportion to it, not to the size of the world.
+    int BurningCellCount() const;
+
+    // What the last tick counted and how long its phases took. All zero unless the core was built with
+    // PPE_ENABLE_COUNTERS, see Counters.h.
+    const TickCounters& LastTickCounters() const;
+
+    // Seed used by engines that never had SetSeed called.
+    static constexpr quint64 DefaultSeed = 1;
+
+    // Seeds every random choice the rules make. Two engines with the same seed, thread count and sequence of edits
+    // and steps end up with bit-identical worlds. Chunks draw from their own stream per tick, so a parallel update
+    // gives the same result with any number of threads above 1, however the chunks get scheduled.
+    void SetSeed(quint64 seed);
+
+    quint64 Seed() const;
+
+    // Sets how many threads update chunks. 1 updates serially on the calling thread.
+    // Anything higher updates in a 4-phase checkerboard where chunks of the same phase never share cells.
+    void SetThreadCount(int threadCount);
+
+    // Number of threads updating chunks, including the one calling UpdateTiles.
+    int ThreadCount() const;
+
+    // Only updates the chunks overlapping region, to keep ticks short when they fall behind. Chunks outside it keep
+    // the cells they were due to update and pick them up once they are inside again. Fire and heat keep to the same
+    // chunks: cells outside them neither burn nor conduct, and fires inside do not spread out of them. An empty
+    // region, the default, updates the whole world. A limited region changes the outcome of a seeded run.
+    void SetUpdateRegion(const QRect& region);
+
+    QRect UpdateRegion() const;
+
+    // The cells of the chunks overlapping the update region, or the whole world without one. Chunk updates, fire
+    // and heat all keep to it.
+    QRect UpdatedArea() const;
+
+protected:
+
+    // Simulates a single tick.
+    void UpdateTiles();
+
+    // Updates every awake chunk in order on the calling thread.
+    void UpdateChunksSerial();
+
+    // Updates awake chunks on the worker pool, one checkerboard phase at a time.
+    void UpdateChunksParallel();
+
+    // Updates the cells inside the chunk's dirty rect, never touching cells outside reach.
+    void UpdateChunk(const Chunk& chunk, const QRect& reach);
+
+    // Burns down every cell in m_burning inside area, spreading the fire to its neighbours inside area. Cells
+    // outside it wait. Does nothing while nothing burns.
+    void Burn(const QRect& area);
+
+    // Sets alight the flammable cells from left to right inclusive on row y, which must lie in the world.
+    void IgniteRow(int yPos, int left, int right);
+
+    // Sets the cell at index alight, which must be flammable and not burning yet, and adds it to m_burning.
+    // key varies how long it burns.
+    void IgniteCell(int index, quint64 key);
+
+    // Lists every cell flagged CellFlag::BURNING afresh, after the cells were written wholesale.
+    void RebuildBurning();
+
+    // Conducts heat between neighbouring cells inside area, in bands of HeatBandHeight rows spread across the worker
+    // pool. Cells outside it keep their temperatures, but still pass heat to the cells inside next to them.
+    // Does nothing once the field has settled.
+    void DiffuseHeat(const QRect& area);
+
+    // Runs DiffuseHeat for the columns from left to right of one band, given the temperatures bordering it in halos,
+    // and queues the cells it leaves outside the phase limits of their material. Returns the largest distance of any
+    // new temperature from AMBIENT_TEMP.
+    float DiffuseHeatBand(int band, const float* halos, int left, int right);
+
+    // Changes the phase of every cell inside area the bands of the last DiffuseHeat queued, once all of them are done.
+    void ApplyPhaseChanges(const QRect& area);
+
+    // Turns the cell at index into its material's colder or hotter phase if its temperature has left the
+    // material's limits, see Mat::Traits::lowerLimit. Returns whether it did.
+    bool ChangePhase(int index);
+
+    // Lays out fresh chunks over the current size, all asleep and all changed so the whole world is redrawn.
+    void ResizeChunks();
+
+    // Stamps the cells of rect outside updated, the rect its chunk updated on the last tick, with the last tick's
+    // parity, as the chunk wakes up or grows. Only cells updated or moved on the last tick are sure to carry it: one
+    // left alone for an even number of ticks carries this tick's and would be skipped as if it had moved already.
+    void RestampWoken(const DirtyRect& rect, const DirtyRect& updated);
+
+    // Grows the dirty rect of every chunk overlapping the inclusive rect, clipped to the world.
+    void MarkDirtyRect(int left, int top, int right, int bottom);
+
+    // Writes material into the cells from left to right inclusive on row y, which must lie in the world,
+    // without marking them.
+    void FillRow(int yPos, int left, int right, Mat::Material material);
+
+    // Copies the temperatures of row y, or AMBIENT_TEMP for rows outside the world, into a row padded with
+    // AMBIENT_TEMP on either side. row points at the cell for x = 0.
+    void CopyTemperatureRow(int yPos, float* row) const;
+
+    // Sets the CellFlag::TICK_PARITY bit of the cell to the current tick's.
+    void StampTick(int index){
+        m_cells.flags[index] = ( m_cells.flags[index] & ~CellFlag::TICK_PARITY ) | m_tickParity;
+    }
+
+protected:
+
+    int m_width;
+    int m_height;
+    CellGrid m_cells;
+    Occupancy m_occupancy;
+    std::vector<Chunk> m_chunks;
+    int m_chunkColumns;
+    int m_chunkRows;
+    int m_activeChunkCount;
+    qint64 m_activeCellCount;
+    std::atomic<qint64> m_skippedUpdateCount;
+    QVector<const Chunk*> m_phaseChunks;
+    WorkerPool m_workerPool;
+    bool m_rowKernels;
+    quint64 m_seed;
+    quint64 m_tickCount;
+    quint8 m_tickParity; // CellFlag::TICK_PARITY for the tick running, or the last one between ticks
+    Recorder* m_recorder;
+    QRect m_updateRegion;
+    std::atomic<bool> m_heatActive;     // Some cell may be away from AMBIENT_TEMP. Set by SetTile from chunk updates
+    std::vector<float> m_heatHalos;     // Rows bordering each band as they were before DiffuseHeat, two per band
+    std::vector<float> m_heatScratch;   // Rows each band of DiffuseHeat works in, reused between ticks
+    std::vector<float> m_heatDeviations; // Result of DiffuseHeatBand for every band
+    std::vector<int> m_phaseChanges;    // Cells each band of DiffuseHeat queued for ApplyPhaseChanges, a fixed share per band
+    std::vector<int> m_phaseChangeCounts; // How many each band queued, or -1 if it ran out of room
+    std::vector<int> m_burning;         // Index of every burning cell, sorted by Burn, with any lit since after them
+    TickCounters m_lastTickCounters;
+    std::atomic<qint64> m_counts[Counters::CounterCount];           // Totals of the tick running, from every chunk
+    std::atomic<qint64> m_phaseNanoseconds[Counters::PhaseCount]; // Same, for the phases timed per chunk
+
+};
+
+#endif // ENGINE_H
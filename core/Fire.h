@@ -0,0 +1,39 @@
+#ifndef FIRE_H
+#define FIRE_H
+
+#include "Elements.h"
+#include <QtGlobal>
+
+// Combustion, run once per tick by Engine::Burn over only the cells that are burning. A burning cell carries
+// CellFlag::BURNING and counts the ticks it has left down in CellGrid::velocity, which the static cells that burn
+// never use, so snapshots and recordings keep fires going. Every tick it holds itself at FlameTemperature, sets
+// alight the flammable edge neighbours the heat has brought to their ignition temperature, and now and then puts
+// smoke into an empty cell above it. Once its ticks run out it turns into smoke itself.
+namespace Fire{
+
+    // Temperature a burning cell holds itself at, in Celsius.
+    constexpr float FlameTemperature = 1000.0f;
+
+    // A burning cell puts smoke into the empty cell above it on one tick in this many.
+    constexpr quint32 SmokeChance = 4;
+
+    // Drawn in place of the material's color while a cell burns.
+    constexpr quint32 FlameColor = 0xFFFF6A00;
+
+    constexpr bool IsFlammable(quint8 material){
+        return Mat::MaterialTraits[material].burnTicks > 0;
+    }
+
+    // Burning cells are tracked by index, and their ticks left live in a signed byte.
+    static_assert([]{
+        for(const Mat::Traits& traits : Mat::MaterialTraits){
+            if(traits.burnTicks > 0 && ( traits.movement != Mat::Movement::STATIC || traits.burnTicks > 127 )){
+                return false;
+            }
+        }
+        return true;
+    }(), "flammable materials must be static and burn for at most 127 ticks");
+
+}
+
+#endif // FIRE_H
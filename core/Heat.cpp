@@ -0,0 +1,145 @@
+#include "Heat.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define PPE_HEAT_SSE2
+#endif
+
+// Looks up the conductivity and 1 / heat capacity of width cells of material.
+// With a handful of materials a scalar lookup in one small table beats selecting among them with SIMD compares.
+void Heat::LoadProperties(const quint8* material, int width, float* conductivity, float* inverseHeatCapacity){
+    for(int x = 0; x < width; ++x){
+        const Properties& properties = PropertiesTable[material[x]];
+        conductivity[x]        = properties.conductivity;
+        inverseHeatCapacity[x] = properties.inverseHeatCapacity;
+    }
+}
+
+// Diffuses one row of width cells from the temperatures its rows had before this tick.
+// The vector and scalar loops do the same operations in the same order, so where a cell falls makes no difference.
+float Heat::DiffuseRow(const float* above, const float* row, const float* below,
+                       const float* conductivityAbove, const float* conductivity, const float* conductivityBelow,
+                       const float* inverseHeatCapacity, float* out, int width){
+    constexpr float ambient = static_cast<float>(AMBIENT_TEMP);
+    float deviation = 0.0f;
+    int x = 0;
+
+#ifdef PPE_HEAT_SSE2
+    const __m128 ambients  = _mm_set1_ps(ambient);
+    const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)); // Clears the sign bit
+    __m128 deviations      = _mm_setzero_ps();
+    for(; x + 4 <= width; x += 4){
+        const __m128 temperature = _mm_loadu_ps(row + x);
+        const __m128 k           = _mm_loadu_ps(conductivity + x);
+        __m128 flux = _mm_mul_ps(_mm_min_ps(k, _mm_loadu_ps(conductivity + x - 1)), _mm_sub_ps(_mm_loadu_ps(row + x - 1), temperature));
+        flux = _mm_add_ps(flux, _mm_mul_ps(_mm_min_ps(k, _mm_loadu_ps(conductivity + x + 1)), _mm_sub_ps(_mm_loadu_ps(row + x + 1), temperature)));
+        flux = _mm_add_ps(flux, _mm_mul_ps(_mm_min_ps(k, _mm_loadu_ps(conductivityAbove + x)), _mm_sub_ps(_mm_loadu_ps(above + x), temperature)));
+        flux = _mm_add_ps(flux, _mm_mul_ps(_mm_min_ps(k, _mm_loadu_ps(conductivityBelow + x)), _mm_sub_ps(_mm_loadu_ps(below + x), temperature)));
+        const __m128 next = _mm_add_ps(temperature, _mm_mul_ps(flux, _mm_loadu_ps(inverseHeatCapacity + x)));
+        _mm_storeu_ps(out + x, next);
+        deviations = _mm_max_ps(deviations, _mm_and_ps(_mm_sub_ps(next, ambients), magnitude));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, deviations);
+    deviation = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+
+    for(; x < width; ++x){
+        const float temperature = row[x];
+        const float k           = conductivity[x];
+        float flux =  std::min(k, conductivity[x - 1])   * ( row[x - 1] - temperature );
+        flux       += std::min(k, conductivity[x + 1])   * ( row[x + 1] - temperature );
+        flux       += std::min(k, conductivityAbove[x])  * ( above[x]   - temperature );
+        flux       += std::min(k, conductivityBelow[x])  * ( below[x]   - temperature );
+        const float next = temperature + flux * inverseHeatCapacity[x];
+        out[x] = next;
+        deviation = std::max(deviation, std::fabs(next - ambient));
+    }
+    return deviation;
+}
+
+namespace{
+
+    // Ids of the materials that change phase, the only ones FindPhaseChanges has to look at.
+    constexpr int ChangingMaterialCount = []{
+        int count = 0;
+        for(const Heat::Limits& limits : Heat::LimitsTable){
+            count += limits.lower > -Mat::Unbounded || limits.upper < Mat::Unbounded;
+        }
+        return count;
+    }();
+
+    constexpr std::array<quint8, ChangingMaterialCount> ChangingMaterials = []{
+        std::array<quint8, ChangingMaterialCount> ids{};
+        int count = 0;
+        for(int id = 0; id < Mat::MaterialCount; ++id){
+            if(Heat::LimitsTable[id].lower > -Mat::Unbounded || Heat::LimitsTable[id].upper < Mat::Unbounded){
+                ids[count++] = static_cast<quint8>(id);
+            }
+        }
+        return ids;
+    }();
+
+}
+
+// Writes the x of every one of width cells whose temperature lies outside the limits of its material to xs, in order.
+// With SSE2 where available, runs of 16 cells none of which can change phase are skipped after one compare per
+// material that can, and the rest select their limits among those materials four cells at a time.
+int Heat::FindPhaseChanges(const quint8* material, const float* temperature, int* xs, int width){
+    int count = 0;
+    int x = 0;
+
+#ifdef PPE_HEAT_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i idBytes[ChangingMaterialCount];
+    __m128i ids[ChangingMaterialCount];
+    __m128  lowerLimits[ChangingMaterialCount];
+    __m128  upperLimits[ChangingMaterialCount];
+    for(int i = 0; i < ChangingMaterialCount; ++i){
+        idBytes[i]     = _mm_set1_epi8(static_cast<char>(ChangingMaterials[i]));
+        ids[i]         = _mm_set1_epi32(ChangingMaterials[i]);
+        lowerLimits[i] = _mm_set1_ps(LimitsTable[ChangingMaterials[i]].lower);
+        upperLimits[i] = _mm_set1_ps(LimitsTable[ChangingMaterials[i]].upper);
+    }
+    for(; x + 16 <= width; x += 16){
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(material + x));
+        __m128i changing = zero;
+        for(int i = 0; i < ChangingMaterialCount; ++i){
+            changing = _mm_or_si128(changing, _mm_cmpeq_epi8(bytes, idBytes[i]));
+        }
+        if(_mm_movemask_epi8(changing) == 0){
+            continue;
+        }
+
+        // Lanes of other materials keep limits of -infinity and infinity, which nothing lies outside of.
+        const __m128i low  = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        const __m128i parts[4] = { _mm_unpacklo_epi16(low, zero),  _mm_unpackhi_epi16(low, zero),
+                                   _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero) };
+        for(int part = 0; part < 4; ++part){
+            __m128 lower = _mm_set1_ps(-Mat::Unbounded);
+            __m128 upper = _mm_set1_ps(Mat::Unbounded);
+            for(int i = 0; i < ChangingMaterialCount; ++i){
+                const __m128 matches = _mm_castsi128_ps(_mm_cmpeq_epi32(parts[part], ids[i]));
+                lower = _mm_or_ps(_mm_andnot_ps(matches, lower), _mm_and_ps(matches, lowerLimits[i]));
+                upper = _mm_or_ps(_mm_andnot_ps(matches, upper), _mm_and_ps(matches, upperLimits[i]));
+            }
+            const __m128 values = _mm_loadu_ps(temperature + x + part * 4);
+            int outside = _mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(values, lower), _mm_cmpgt_ps(values, upper)));
+            for(int lane = x + part * 4; outside != 0; ++lane, outside >>= 1){
+                xs[count] = lane;
+                count += outside & 1;
+            }
+        }
+    }
+#endif
+
+    for(; x < width; ++x){
+        const Limits& limits = LimitsTable[material[x]];
+        xs[count] = x;
+        count += temperature[x] < limits.lower || temperature[x] > limits.upper;
+    }
+    return count;
+}
@@ -0,0 +1,79 @@
+#ifndef HEAT_H
+#define HEAT_H
+
+#include "Elements.h"
+#include <QtGlobal>
+#include <array>
+#include <limits>
+
+// Heat conduction through CellGrid::temperature, run over the whole world once per tick by Engine::DiffuseHeat.
+// Every pair of edge neighbours exchanges the smaller of their Mat::Traits::conductivity times their difference in
+// temperature, and each cell's temperature moves by the heat it gained over its heat capacity, so heat is conserved
+// inside the world. Cells past its edges are held at AMBIENT_TEMP, which is where heat eventually leaves.
+// The same pass finds the cells whose temperature has left the limits of their material, see Mat::Traits::lowerLimit,
+// so phase changes never need a scan of their own.
+namespace Heat{
+
+    // Once no cell is this many degrees from AMBIENT_TEMP the field has settled and DiffuseHeat stops running.
+    constexpr float SettledDelta = 0.01f;
+
+    // Conductivity of the cells past the world's edges. Large enough that the cell inside always sets the exchange.
+    constexpr float EdgeConductivity = std::numeric_limits<float>::max();
+
+    // What the pass needs of a material, packed so a cell's lookup touches a single table entry.
+    struct Properties{
+        float conductivity;
+        float inverseHeatCapacity; // 1 / heat capacity
+    };
+
+    struct Limits{
+        float lower;
+        float upper;
+    };
+
+    // Properties and phase limits of Mat::MaterialTraits, indexed by material id.
+    inline constexpr std::array<Properties, Mat::MaterialCount> PropertiesTable = []{
+        std::array<Properties, Mat::MaterialCount> properties{};
+        for(int i = 0; i < Mat::MaterialCount; ++i){
+            properties[i] = { Mat::MaterialTraits[i].conductivity, 1.0f / Mat::MaterialTraits[i].heatCapacity };
+        }
+        return properties;
+    }();
+
+    inline constexpr std::array<Limits, Mat::MaterialCount> LimitsTable = []{
+        std::array<Limits, Mat::MaterialCount> limits{};
+        for(int i = 0; i < Mat::MaterialCount; ++i){
+            limits[i] = { Mat::MaterialTraits[i].lowerLimit, Mat::MaterialTraits[i].upperLimit };
+        }
+        return limits;
+    }();
+
+    // A cell exchanges heat with four neighbours, so this keeps a tick from moving it past their temperatures.
+    static_assert([]{
+        for(const Mat::Traits& traits : Mat::MaterialTraits){
+            if(traits.conductivity < 0.0f || 4.0f * traits.conductivity > traits.heatCapacity){
+                return false;
+            }
+        }
+        return true;
+    }(), "every material needs a heat capacity of at least 4 x its conductivity");
+
+    // Looks up the conductivity and 1 / heat capacity of width cells of material in PropertiesTable.
+    void LoadProperties(const quint8* material, int width, float* conductivity, float* inverseHeatCapacity);
+
+    // Diffuses one row of width cells. above, row and below hold the temperatures of the row and its neighbours from
+    // before this tick, and the conductivity arrays those of their cells. All six are read from index -1 to width,
+    // one cell past either end. Writes the row's new temperatures to out and returns the largest distance of any of
+    // them from AMBIENT_TEMP. Four cells at a time with SSE2 where available.
+    float DiffuseRow(const float* above, const float* row, const float* below,
+                     const float* conductivityAbove, const float* conductivity, const float* conductivityBelow,
+                     const float* inverseHeatCapacity, float* out, int width);
+
+    // Writes the x of every one of width cells whose temperature lies outside the limits of its material to xs,
+    // in order, and returns how many there are. xs needs room for width of them. With SSE2 where available, skipping
+    // 16 cells at a time while none of them is of a material that changes phase.
+    int FindPhaseChanges(const quint8* material, const float* temperature, int* xs, int width);
+
+}
+
+#endif // HEAT_H
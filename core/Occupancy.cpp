@@ -0,0 +1,254 @@
+#include "Occupancy.h"
+#include "CellGrid.h"
+#include "Elements.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+namespace{
+
+    // Word word of a line of bits, a row or a column, moved along by shift: put together from the two words of the
+    // old line, oldWords long, that it straddles. Bits past length, the end of the new line, are cleared. Bits past
+    // the end of the old line are always clear, so whole old words can be read without masking them.
+    quint64 ShiftedWord(const std::atomic<quint64>* line, int oldWords, int word, int shift, int length){
+        auto OldWord = [&](int index){
+            return index >= 0 && index < oldWords ? line[index].load(std::memory_order_relaxed) : quint64(0);
+        };
+        // First old bit of the word, rounded down to a word boundary and the bits past it.
+        const int fromBit  = word * 64 - shift;
+        const int fromWord = fromBit >= 0 ? fromBit / 64 : -( ( 63 - fromBit ) / 64 );
+        const int offset   = fromBit - fromWord * 64;
+        quint64 bits = OldWord(fromWord) >> offset;
+        if(offset != 0){
+            bits |= OldWord(fromWord + 1) << ( 64 - offset );
+        }
+        // Bits moved past the end are gone.
+        const int valid = length - word * 64;
+        if(valid < 64){
+            bits &= ( quint64(1) << valid ) - 1;
+        }
+        return bits;
+    }
+
+}
+
+Occupancy::Occupancy() :
+    m_width(0)
+  , m_height(0)
+  , m_wordsPerRow(0)
+  , m_wordsPerColumn(0)
+{
+    Resize(0, 0);
+}
+
+// Reallocates the bits for width x height cells, all clear.
+void Occupancy::Resize(int width, int height){
+    m_width       = std::max(width,  0);
+    m_height      = std::max(height, 0);
+    m_wordsPerRow    = ( m_width + 63 ) / 64;
+    m_wordsPerColumn = ( m_height + 63 ) / 64;
+
+    const size_t count = static_cast<size_t>(PlaneCount) * m_height * m_wordsPerRow;
+    m_words.reset(new std::atomic<quint64>[count]);
+    for(size_t i = 0; i < count; ++i){
+        m_words[i].store(0, std::memory_order_relaxed);
+    }
+
+    const size_t columnCount = static_cast<size_t>(m_width) * m_wordsPerColumn;
+    m_columnWords.reset(new std::atomic<quint64>[columnCount]);
+    for(size_t i = 0; i < columnCount; ++i){
+        m_columnWords[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// Reallocates the bits keeping those of the cells that still fit, each moved by shiftX, shiftY.
+// Every new row word is put together from the two old words it straddles, and every column word likewise, so the
+// cost is a word per 64 cells rather than a look at every occupied one.
+void Occupancy::Resize(int width, int height, int shiftX, int shiftY){
+    const std::unique_ptr<std::atomic<quint64>[]> oldWords       = std::move(m_words);
+    const std::unique_ptr<std::atomic<quint64>[]> oldColumnWords = std::move(m_columnWords);
+    const int oldWidth          = m_width;
+    const int oldHeight         = m_height;
+    const int oldWordsPerRow    = m_wordsPerRow;
+    const int oldWordsPerColumn = m_wordsPerColumn;
+
+    Resize(width, height);
+
+    for(int plane = 0; plane < PlaneCount; ++plane){
+        for(int y = 0; y < m_height; ++y){
+            const int fromY = y - shiftY;
+            if(fromY < 0 || fromY >= oldHeight){
+                continue;
+            }
+            const std::atomic<quint64>* from = &oldWords[( plane * oldHeight + fromY ) * oldWordsPerRow];
+            for(int word = 0; word < m_wordsPerRow; ++word){
+                Word(static_cast<Plane>(plane), word * 64, y).store(ShiftedWord(from, oldWordsPerRow, word, shiftX, m_width),
+                                                                   std::memory_order_relaxed);
+            }
+        }
+    }
+
+    for(int x = 0; x < m_width; ++x){
+        const int fromX = x - shiftX;
+        if(fromX < 0 || fromX >= oldWidth){
+            continue;
+        }
+        const std::atomic<quint64>* from = &oldColumnWords[static_cast<size_t>(fromX) * oldWordsPerColumn];
+        for(int word = 0; word < m_wordsPerColumn; ++word){
+            ColumnWord(x, word * 64).store(ShiftedWord(from, oldWordsPerColumn, word, shiftY, m_height), std::memory_order_relaxed);
+        }
+    }
+}
+
+// Recomputes every bit from the cells, a word at a time.
+void Occupancy::Rebuild(const CellGrid& cells){
+    for(int y = 0; y < m_height; ++y){
+        const quint8* material = cells.material + cells.Index(0, y);
+        const quint8* density  = cells.density  + cells.Index(0, y);
+        for(int word = 0; word < m_wordsPerRow; ++word){
+            quint64 occupied = 0;
+            quint64 solid    = 0;
+            const int first = word * 64;
+            const int last  = std::min(first + 64, m_width);
+            for(int x = first; x < last; ++x){
+                occupied |= quint64(material[x] != Mat::Material::EMPTY) << ( x - first );
+                solid    |= quint64(density[x] > Mat::MaxLiquidDensity)  << ( x - first );
+            }
+            Word(OCCUPIED, first, y).store(occupied, std::memory_order_relaxed);
+            Word(SOLID,    first, y).store(solid,    std::memory_order_relaxed);
+        }
+    }
+    RebuildColumns();
+}
+
+// Recomputes the column bits from the OCCUPIED rows, one set bit at a time.
+void Occupancy::RebuildColumns(){
+    const size_t columnCount = static_cast<size_t>(m_width) * m_wordsPerColumn;
+    for(size_t i = 0; i < columnCount; ++i){
+        m_columnWords[i].store(0, std::memory_order_relaxed);
+    }
+    for(int y = 0; y < m_height; ++y){
+        for(int wordX = 0; wordX < m_width; wordX += 64){
+            quint64 bits = Word(OCCUPIED, wordX, y).load(std::memory_order_relaxed);
+            while(bits != 0){
+                std::atomic<quint64>& column = ColumnWord(wordX + qCountTrailingZeroBits(bits), y);
+                column.store(column.load(std::memory_order_relaxed) | Bit(y), std::memory_order_relaxed);
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+// Sets both bits of the cell at x, y, and its column bit.
+void Occupancy::Set(int xPos, int yPos, bool occupied, bool solid){
+    const bool values[PlaneCount] = { occupied, solid };
+    for(int plane = 0; plane < PlaneCount; ++plane){
+        Write(Word(static_cast<Plane>(plane), xPos, yPos), Bit(xPos), values[plane]);
+    }
+    Write(ColumnWord(xPos, yPos), Bit(yPos), occupied);
+}
+
+// Sets both bits of the cells from left to right inclusive on row y, a word at a time, and their column bits,
+// which lie in a word per cell.
+void Occupancy::SetRun(int yPos, int left, int right, bool occupied, bool solid){
+    const bool values[PlaneCount] = { occupied, solid };
+    for(int plane = 0; plane < PlaneCount; ++plane){
+        for(int first = left; first <= right; first = ( first | 63 ) + 1){
+            const int last = std::min(first | 63, right);
+            const quint64 mask = ( ~quint64(0) >> ( 63 - ( last - first ) ) ) << ( first & 63 );
+            Write(Word(static_cast<Plane>(plane), first, yPos), mask, values[plane]);
+        }
+    }
+    for(int x = left; x <= right; ++x){
+        Write(ColumnWord(x, yPos), Bit(yPos), occupied);
+    }
+}
+
+// Exchanges the bits of two cells. Only planes where the two cells differ are written.
+void Occupancy::Swap(int xPos1, int yPos1, int xPos2, int yPos2){
+    // Swapping two different bits is flipping both of them.
+    auto Flip = [](std::atomic<quint64>& word1, quint64 bit1, std::atomic<quint64>& word2, quint64 bit2){
+        if(&word1 == &word2){
+            word1.fetch_xor(bit1 | bit2, std::memory_order_relaxed);
+        }else{
+            word1.fetch_xor(bit1, std::memory_order_relaxed);
+            word2.fetch_xor(bit2, std::memory_order_relaxed);
+        }
+    };
+
+    for(int plane = 0; plane < PlaneCount; ++plane){
+        std::atomic<quint64>& word1 = Word(static_cast<Plane>(plane), xPos1, yPos1);
+        std::atomic<quint64>& word2 = Word(static_cast<Plane>(plane), xPos2, yPos2);
+        const bool bit1 = word1.load(std::memory_order_relaxed) & Bit(xPos1);
+        const bool bit2 = word2.load(std::memory_order_relaxed) & Bit(xPos2);
+        if(bit1 == bit2) continue;
+
+        Flip(word1, Bit(xPos1), word2, Bit(xPos2));
+        if(plane == OCCUPIED){
+            // The column bits hold the same, so they differ as well.
+            Flip(ColumnWord(xPos1, yPos1), Bit(yPos1), ColumnWord(xPos2, yPos2), Bit(yPos2));
+        }
+    }
+}
+
+bool Occupancy::Test(Plane plane, int xPos, int yPos) const{
+    return Word(plane, xPos, yPos).load(std::memory_order_relaxed) & Bit(xPos);
+}
+
+// Returns the x closest to from, searching row y from from towards to, whose bit in plane equals value, or -1.
+int Occupancy::FindNearest(Plane plane, bool value, int yPos, int from, int to) const{
+    const quint64 invert = value ? 0 : ~quint64(0);
+
+    if(to >= from){
+        // Rightwards: mask off the bits left of from in the first word, then take the lowest set bit.
+        quint64 mask = ~quint64(0) << ( from & 63 );
+        for(int wordX = from & ~63; wordX <= to; wordX += 64){
+            const quint64 bits = ( Word(plane, wordX, yPos).load(std::memory_order_relaxed) ^ invert ) & mask;
+            if(bits != 0){
+                const int x = wordX + qCountTrailingZeroBits(bits);
+                return x <= to ? x : -1;
+            }
+            mask = ~quint64(0);
+        }
+    }else{
+        // Leftwards: mask off the bits right of from in the first word, then take the highest set bit.
+        quint64 mask = ~quint64(0) >> ( 63 - ( from & 63 ) );
+        for(int wordX = from & ~63; wordX + 63 >= to; wordX -= 64){
+            const quint64 bits = ( Word(plane, wordX, yPos).load(std::memory_order_relaxed) ^ invert ) & mask;
+            if(bits != 0){
+                const int x = wordX + 63 - qCountLeadingZeroBits(bits);
+                return x >= to ? x : -1;
+            }
+            mask = ~quint64(0);
+        }
+    }
+    return -1;
+}
+
+// Returns the y closest to from, searching column x from from towards to, whose OCCUPIED bit equals value, or -1.
+// The same search as FindNearest, down the column's words instead of along a row's.
+int Occupancy::FindNearestInColumn(bool value, int xPos, int from, int to) const{
+    const quint64 invert = value ? 0 : ~quint64(0);
+
+    if(to >= from){
+        quint64 mask = ~quint64(0) << ( from & 63 );
+        for(int wordY = from & ~63; wordY <= to; wordY += 64){
+            const quint64 bits = ( ColumnWord(xPos, wordY).load(std::memory_order_relaxed) ^ invert ) & mask;
+            if(bits != 0){
+                const int y = wordY + qCountTrailingZeroBits(bits);
+                return y <= to ? y : -1;
+            }
+            mask = ~quint64(0);
+        }
+    }else{
+        quint64 mask = ~quint64(0) >> ( 63 - ( from & 63 ) );
+        for(int wordY = from & ~63; wordY + 63 >= to; wordY -= 64){
+            const quint64 bits = ( ColumnWord(xPos, wordY).load(std::memory_order_relaxed) ^ invert ) & mask;
+            if(bits != 0){
+                const int y = wordY + 63 - qCountLeadingZeroBits(bits);
+                return y >= to ? y : -1;
+            }
+            mask = ~quint64(0);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,97 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+class CellGrid;
+
+// One bit per cell, packed 64 to a word along each row, for a couple of yes/no questions the rules ask about
+// long stretches of a row. Finding the nearest cell of a kind is then a count-trailing-zeros per 64 cells
+// instead of a lookup per cell. Whether cells are occupied is also kept packed down each column, for falls.
+// Words are atomic because cells of neighbouring chunks share words and may be swapped from several threads at once.
+class Occupancy
+{
+
+public:
+
+    enum Plane{
+        OCCUPIED = 0, // Anything but EMPTY
+        SOLID    = 1, // Denser than every liquid, so no liquid can flow through it
+        PlaneCount
+    };
+
+    Occupancy();
+
+    Occupancy(const Occupancy&) = delete;
+    Occupancy& operator=(const Occupancy&) = delete;
+
+    // Reallocates the bits for width x height cells, all clear.
+    void Resize(int width, int height);
+
+    // Reallocates the bits for width x height cells keeping those of the cells that still fit, each moved by
+    // shiftX, shiftY, as CellGrid::Resize does. The bits of new cells are clear.
+    void Resize(int width, int height, int shiftX, int shiftY);
+
+    // Recomputes every bit from the cells, after they were written behind Set and Swap's back. cells must be this size.
+    void Rebuild(const CellGrid& cells);
+
+    // Sets both bits of the cell at x, y.
+    void Set(int xPos, int yPos, bool occupied, bool solid);
+
+    // Sets both bits of the cells from left to right inclusive on row y, a word at a time.
+    void SetRun(int yPos, int left, int right, bool occupied, bool solid);
+
+    // Exchanges the bits of two cells, mirroring CellGrid::Swap.
+    void Swap(int xPos1, int yPos1, int xPos2, int yPos2);
+
+    bool Test(Plane plane, int xPos, int yPos) const;
+
+    // Returns the x closest to from, searching row y from from towards to (both inclusive, to may lie on either side),
+    // whose bit in plane equals value. Returns -1 if there is none.
+    int FindNearest(Plane plane, bool value, int yPos, int from, int to) const;
+
+    // Returns the y closest to from, searching column x from from towards to (both inclusive, to may lie on either
+    // side), whose OCCUPIED bit equals value. Returns -1 if there is none.
+    int FindNearestInColumn(bool value, int xPos, int from, int to) const;
+
+protected:
+
+    // Recomputes the column bits from the OCCUPIED rows.
+    void RebuildColumns();
+
+    std::atomic<quint64>& Word(Plane plane, int xPos, int yPos) const{
+        return m_words[( plane * m_height + yPos ) * m_wordsPerRow + ( xPos >> 6 )];
+    }
+
+    std::atomic<quint64>& ColumnWord(int xPos, int yPos) const{
+        return m_columnWords[xPos * m_wordsPerColumn + ( yPos >> 6 )];
+    }
+
+    // Bit of x in its row's word, or of y in its column's word.
+    static quint64 Bit(int position){
+        return quint64(1) << ( position & 63 );
+    }
+
+    // Sets or clears bits in word.
+    static void Write(std::atomic<quint64>& word, quint64 bits, bool value){
+        if(value){
+            word.fetch_or(bits, std::memory_order_relaxed);
+        }else{
+            word.fetch_and(~bits, std::memory_order_relaxed);
+        }
+    }
+
+protected:
+
+    int m_width;
+    int m_height;
+    int m_wordsPerRow;
+    int m_wordsPerColumn;
+    std::unique_ptr<std::atomic<quint64>[]> m_words;       // PlaneCount planes of m_height rows of m_wordsPerRow words
+    std::unique_ptr<std::atomic<quint64>[]> m_columnWords; // OCCUPIED again, m_width columns of m_wordsPerColumn words
+
+};
+
+#endif // OCCUPANCY_H
@@ -0,0 +1,55 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <QtGlobal>
+
+// Small, fast PCG32 generator (O'Neill, pcg-random.org). Eight bytes of state and one multiply per number,
+// no locks and no hidden global state, so every chunk update can own one and seeded runs repeat exactly.
+class Random
+{
+
+public:
+
+    // Distinct streams with the same seed produce unrelated sequences.
+    Random(quint64 seed, quint64 stream) :
+        m_state(0)
+      , m_increment(( stream << 1 ) | 1)
+    {
+        Next();
+        m_state += seed;
+        Next();
+    }
+
+    quint32 Next(){
+        const quint64 state = m_state;
+        m_state = state * 6364136223846793005ULL + m_increment;
+        const quint32 xorShifted = static_cast<quint32>(( ( state >> 18 ) ^ state ) >> 27);
+        const quint32 rotation   = static_cast<quint32>(state >> 59);
+        return ( xorShifted >> rotation ) | ( xorShifted << ( ( 0u - rotation ) & 31 ) );
+    }
+
+    bool NextBool(){
+        return Next() >> 31;
+    }
+
+    // Uniform in [0, bound) for bound > 0, by multiply and shift. Biased by at most bound / 2^32, which does not matter here.
+    quint32 Bounded(quint32 bound){
+        return static_cast<quint32>(( static_cast<quint64>(Next()) * bound ) >> 32);
+    }
+
+    // SplitMix64 finalizer. Spreads structured keys like (seed, tick) over all 64 bits before they seed a stream.
+    static quint64 Mix(quint64 value){
+        value += 0x9E3779B97F4A7C15ULL;
+        value  = ( value ^ ( value >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+        value  = ( value ^ ( value >> 27 ) ) * 0x94D049BB133111EBULL;
+        return value ^ ( value >> 31 );
+    }
+
+protected:
+
+    quint64 m_state;
+    quint64 m_increment;
+
+};
+
+#endif // RANDOM_H
@@ -0,0 +1,482 @@
+#include "Recording.h"
+#include "Engine.h"
+#include "CellGrid.h"
+#include "Elements.h"
+#include "Snapshot.h"
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace{
+
+    const char Magic[8]     = { 'P', 'P', 'E', 'R', 'E', 'C', '\0', '\0' };
+    const char TailMagic[8] = { 'P', 'P', 'E', 'R', 'T', 'A', 'I', 'L' };
+
+    enum RecordType : quint32{
+        KEYFRAME = 1,
+        DELTA    = 2,
+        INDEX    = 3,
+    };
+
+    constexpr quint64 FileHeaderSize   = 16; // magic, version, keyframe interval
+    constexpr quint64 RecordHeaderSize = 24; // type, reserved, tick, payload size
+    constexpr quint64 TailSize         = 24; // index offset, last tick, magic
+    constexpr quint64 IndexEntrySize   = 16; // tick, offset
+    constexpr int MaxDeltaEntrySize    = 14; // index gap varint, field mask and every field
+
+    // Bits of a DELTA entry's field mask, in the order the fields follow it.
+    enum DeltaField : quint8{
+        MATERIAL    = 1 << 0,
+        DENSITY     = 1 << 1,
+        VELOCITY    = 1 << 2,
+        FLAGS       = 1 << 3,
+        TEMPERATURE = 1 << 4,
+    };
+
+    // Every recorded field of a cell in one word, one byte each for material, density, velocity and flags in DELTA
+    // field order, then the bits of the temperature. Recorded flags leave out the tick parity, see Replay::Seek.
+    quint64 PackCell(const CellGrid& cells, int index){
+        quint32 temperature;
+        std::memcpy(&temperature, &cells.temperature[index], sizeof(temperature));
+        return quint64(cells.material[index])
+             | quint64(cells.density[index]) << 8
+             | quint64(static_cast<quint8>(cells.velocity[index])) << 16
+             | quint64(cells.flags[index] & ~CellFlag::TICK_PARITY) << 24
+             | quint64(temperature) << 32;
+    }
+
+    template<typename T>
+    void Append(QByteArray& bytes, T value){
+        value = qToLittleEndian(value);
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    T Read(const uchar* bytes){
+        return qFromLittleEndian<T>(bytes);
+    }
+
+    bool Reject(QString* error, const QString& message){
+        if(error != nullptr){
+            *error = message;
+        }
+        return false;
+    }
+
+}
+
+Recorder::Recorder() :
+    m_file(QString())
+  , m_engine(nullptr)
+  , m_keyframeInterval(Recording::DefaultKeyframeInterval)
+  , m_keyframePending(false)
+  , m_lastKeyframeTick(0)
+  , m_lastTick(0)
+  , m_cellCount(0)
+{
+}
+
+Recorder::~Recorder(){
+    Finish();
+}
+
+// Starts recording into path with a keyframe of the engine's current state, and attaches to the engine.
+bool Recorder::Start(const QString& path, Engine& engine, int keyframeInterval, QString* error){
+    Finish();
+    m_error.clear();
+    m_keyframes.clear();
+
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        return Reject(error, QString("%0: %1").arg(path).arg(m_file.errorString()));
+    }
+
+    QByteArray header(Magic, sizeof(Magic));
+    Append(header, Recording::Version);
+    Append(header, static_cast<quint32>(std::max(keyframeInterval, 1)));
+    m_keyframeInterval = std::max(keyframeInterval, 1);
+
+    m_engine = &engine;
+    Reset(engine.Cells().Count());
+    if(m_file.write(header) != header.size() || !WriteKeyframe(engine)){
+        const QString message = QString("%0: %1").arg(path).arg(m_file.errorString());
+        m_engine = nullptr;
+        m_file.close();
+        return Reject(error, message);
+    }
+    engine.SetRecorder(this);
+    return true;
+}
+
+// Writes the keyframe index, detaches from the engine and closes the file.
+bool Recorder::Finish(QString* error){
+    if(m_engine != nullptr){
+        m_engine->SetRecorder(nullptr);
+        m_engine = nullptr;
+
+        QByteArray index;
+        for(const Keyframe& keyframe : m_keyframes){
+            Append(index, keyframe.tick);
+            Append(index, keyframe.offset);
+        }
+        const quint64 indexOffset = static_cast<quint64>(m_file.pos());
+        QByteArray tail;
+        Append(tail, indexOffset);
+        Append(tail, m_lastTick);
+        tail.append(TailMagic, sizeof(TailMagic));
+        if(!WriteRecord(INDEX, m_lastTick, index.constData(), index.size()) || m_file.write(tail) != tail.size()){
+            Fail(m_file.errorString());
+        }
+    }
+    if(m_file.isOpen()){
+        m_file.close();
+    }
+    return m_error.isEmpty() || Reject(error, m_error);
+}
+
+bool Recorder::IsRecording() const{
+    return m_engine != nullptr;
+}
+
+// Writes what changed during the tick the engine just finished.
+// A keyframe replaces the tick's delta, so the bits are cleared either way.
+void Recorder::EndTick(const Engine& engine){
+    if(m_engine == nullptr) return;
+
+    m_lastTick = engine.TickCount();
+    if(m_keyframePending || m_lastTick - m_lastKeyframeTick >= static_cast<quint64>(m_keyframeInterval)){
+        ClearChanged();
+        if(!WriteKeyframe(engine)){
+            Fail(m_file.errorString());
+        }
+    }else if(!WriteDelta(engine)){
+        Fail(m_file.errorString());
+    }
+}
+
+// Forgets the changes collected so far and makes the next tick a keyframe.
+void Recorder::Reset(int cellCount){
+    m_cellCount = std::max(cellCount, 0);
+    m_changed.reset(new std::atomic<quint64>[static_cast<size_t>(BlockCount()) * WordsPerBlock]);
+    m_changedBlocks.reset(new std::atomic<quint8>[BlockCount()]);
+    ClearChanged();
+    m_keyframePending = true;
+}
+
+int Recorder::BlockCount() const{
+    return ( m_cellCount + CellsPerBlock - 1 ) / CellsPerBlock;
+}
+
+void Recorder::ClearChanged(){
+    for(int word = 0; word < BlockCount() * WordsPerBlock; ++word){
+        m_changed[word].store(0, std::memory_order_relaxed);
+    }
+    for(int block = 0; block < BlockCount(); ++block){
+        m_changedBlocks[block].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool Recorder::WriteRecord(quint32 type, quint64 tick, const char* payload, qint64 size){
+    QByteArray header;
+    Append(header, type);
+    Append(header, quint32(0));
+    Append(header, tick);
+    Append(header, static_cast<quint64>(size));
+    return m_file.write(header) == header.size() && ( size == 0 || m_file.write(payload, size) == size );
+}
+
+// A snapshot's size is only known once it is written, so the record header is patched afterwards.
+bool Recorder::WriteKeyframe(const Engine& engine){
+    const qint64 offset = m_file.pos();
+    if(!WriteRecord(KEYFRAME, engine.TickCount(), nullptr, 0) || !Snapshot::Write(m_file, engine, Snapshot::Compression::RLE)){
+        return false;
+    }
+    const qint64 end = m_file.pos();
+    QByteArray size;
+    Append(size, static_cast<quint64>(end - offset - RecordHeaderSize));
+    if(!m_file.seek(offset + RecordHeaderSize - sizeof(quint64)) || m_file.write(size) != size.size() || !m_file.seek(end)){
+        return false;
+    }
+
+    // Deltas from here on are taken against the keyframe.
+    const CellGrid& cells = engine.Cells();
+    m_previous.resize(static_cast<size_t>(cells.Count()));
+    for(int index = 0; index < cells.Count(); ++index){
+        m_previous[index] = PackCell(cells, index);
+    }
+
+    m_keyframes.append({ engine.TickCount(), static_cast<quint64>(offset) });
+    m_lastKeyframeTick = engine.TickCount();
+    m_keyframePending  = false;
+    return true;
+}
+
+// Takes every set bit of the change bitset, clearing it, and writes the fields of those cells that differ from
+// the last record. Only blocks flagged by Touch are scanned, so a quiet world costs next to nothing.
+// A cell that moved away and back, or swapped with its twin, writes nothing, nor does a tick where nothing changed.
+bool Recorder::WriteDelta(const Engine& engine){
+    const CellGrid& cells = engine.Cells();
+    int size = 0;
+    int nextIndex = 0;
+    for(int block = 0; block < BlockCount(); ++block){
+        if(m_changedBlocks[block].load(std::memory_order_relaxed) == 0) continue;
+        m_changedBlocks[block].store(0, std::memory_order_relaxed);
+
+        // Room for every cell of the block, so the entries can be written in place.
+        if(m_delta.size() - size < CellsPerBlock * MaxDeltaEntrySize){
+            m_delta.resize(std::max(2 * m_delta.size(), size + CellsPerBlock * MaxDeltaEntrySize));
+        }
+        uchar* const begin = reinterpret_cast<uchar*>(m_delta.data());
+        uchar* entry = begin + size;
+
+        for(int word = block * WordsPerBlock; word < ( block + 1 ) * WordsPerBlock; ++word){
+            if(m_changed[word].load(std::memory_order_relaxed) == 0) continue;
+            quint64 bits = m_changed[word].exchange(0, std::memory_order_relaxed);
+            while(bits != 0){
+                const int index = word * 64 + qCountTrailingZeroBits(bits);
+                bits &= bits - 1;
+                entry = EncodeCell(cells, index, nextIndex, entry);
+            }
+        }
+        size = static_cast<int>(entry - begin);
+    }
+    return size == 0 || WriteRecord(DELTA, engine.TickCount(), m_delta.constData(), size);
+}
+
+// Writes the DELTA entry of the cell at index into entry if it differs from the last record, and returns the end
+// of what was written. nextIndex is one past the index of the previous entry.
+uchar* Recorder::EncodeCell(const CellGrid& cells, int index, int& nextIndex, uchar* entry){
+    // One load and compare against the last record, instead of one per field.
+    const quint64 cell = PackCell(cells, index);
+    const quint64 changed = cell ^ m_previous[index];
+    if(changed == 0) return entry;
+    m_previous[index] = cell;
+
+    for(quint32 gap = static_cast<quint32>(index - nextIndex); ; gap >>= 7){
+        *entry++ = static_cast<uchar>(( gap & 0x7f ) | ( gap >= 0x80 ? 0x80 : 0 ));
+        if(gap < 0x80) break;
+    }
+    nextIndex = index + 1;
+
+    uchar& mask = *entry++;
+    mask = 0;
+    for(int field = 0; field < 4; ++field){
+        if(( changed >> ( 8 * field ) ) & 0xff){
+            mask |= 1 << field;
+            *entry++ = static_cast<uchar>(cell >> ( 8 * field ));
+        }
+    }
+    if(changed >> 32){
+        mask |= TEMPERATURE;
+        qToLittleEndian(static_cast<quint32>(cell >> 32), entry);
+        entry += sizeof(quint32);
+    }
+    return entry;
+}
+
+// Stops recording after a failed write, keeping the first error for Finish.
+void Recorder::Fail(const QString& error){
+    if(m_error.isEmpty()){
+        m_error = QString("%0: %1").arg(m_file.fileName()).arg(error);
+    }
+    if(m_engine != nullptr){
+        m_engine->SetRecorder(nullptr);
+        m_engine = nullptr;
+    }
+}
+
+Replay::Replay() :
+    m_file(QString())
+  , m_bytes(nullptr)
+  , m_size(0)
+  , m_lastTick(0)
+{
+}
+
+// Maps the recording at path and finds its keyframes, from the index if it has one.
+bool Replay::Open(const QString& path, QString* error){
+    m_file.close();
+    m_contents.clear();
+    m_keyframes.clear();
+    m_bytes    = nullptr;
+    m_size     = 0;
+    m_lastTick = 0;
+
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadOnly)){
+        return Reject(error, QString("%0: %1").arg(path).arg(m_file.errorString()));
+    }
+    m_size  = static_cast<quint64>(m_file.size());
+    m_bytes = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if(m_bytes == nullptr){
+        m_contents = m_file.readAll();
+        m_bytes    = reinterpret_cast<const uchar*>(m_contents.constData());
+        m_size     = static_cast<quint64>(m_contents.size());
+    }
+
+    if(m_size < FileHeaderSize || std::memcmp(m_bytes, Magic, sizeof(Magic)) != 0){
+        return Reject(error, QString("%0: not a recording").arg(path));
+    }
+    const quint32 version = Read<quint32>(m_bytes + sizeof(Magic));
+    if(version == 0 || version > Recording::Version){
+        return Reject(error, QString("%0: unsupported recording version %1").arg(path).arg(version));
+    }
+
+    // The index is only trusted if the tail points at an INDEX record that ends right where the tail starts.
+    const uchar* tail = m_size >= FileHeaderSize + RecordHeaderSize + TailSize ? m_bytes + m_size - TailSize : nullptr;
+    const quint64 indexOffset = tail != nullptr ? Read<quint64>(tail) : 0;
+    const bool hasIndex = tail != nullptr
+                       && indexOffset >= FileHeaderSize
+                       && indexOffset <= m_size - TailSize - RecordHeaderSize
+                       && std::memcmp(tail + 2 * sizeof(quint64), TailMagic, sizeof(TailMagic)) == 0
+                       && Read<quint32>(m_bytes + indexOffset) == INDEX
+                       && Read<quint64>(m_bytes + indexOffset + 16) == m_size - TailSize - indexOffset - RecordHeaderSize;
+    if(hasIndex){
+        const quint64 entries = Read<quint64>(m_bytes + indexOffset + 16) / IndexEntrySize;
+        for(quint64 i = 0; i < entries; ++i){
+            const uchar* entry = m_bytes + indexOffset + RecordHeaderSize + i * IndexEntrySize;
+            const Keyframe keyframe = { Read<quint64>(entry), Read<quint64>(entry + sizeof(quint64)) };
+            if(keyframe.offset < FileHeaderSize || keyframe.offset > indexOffset - RecordHeaderSize) break;
+            m_keyframes.append(keyframe);
+        }
+        m_lastTick = Read<quint64>(tail + sizeof(quint64));
+    }else{
+        ScanRecords();
+    }
+
+    if(m_keyframes.isEmpty()){
+        return Reject(error, QString("%0: recording holds no keyframe").arg(path));
+    }
+    return true;
+}
+
+// Finds the keyframes by walking every record, stopping at the first one that is cut short.
+void Replay::ScanRecords(){
+    quint64 position = FileHeaderSize;
+    while(m_size - position >= RecordHeaderSize){
+        const quint32 type = Read<quint32>(m_bytes + position);
+        const quint64 tick = Read<quint64>(m_bytes + position + 8);
+        const quint64 size = Read<quint64>(m_bytes + position + 16);
+        if(size > m_size - position - RecordHeaderSize || type == INDEX) break;
+        if(type == KEYFRAME){
+            if(size == 0) break; // Its header was never patched
+            m_keyframes.append({ tick, position });
+        }
+        m_lastTick = std::max(m_lastTick, tick);
+        position += RecordHeaderSize + size;
+    }
+}
+
+quint64 Replay::FirstTick() const{
+    return m_keyframes.isEmpty() ? 0 : m_keyframes.first().tick;
+}
+
+quint64 Replay::LastTick() const{
+    return m_lastTick;
+}
+
+int Replay::KeyframeCount() const{
+    return m_keyframes.size();
+}
+
+// Loads the nearest keyframe at or before tick and applies the deltas recorded after it, up to tick.
+bool Replay::Seek(quint64 tick, Engine& engine, QString* error){
+    if(m_keyframes.isEmpty() || tick < FirstTick() || tick > LastTick()){
+        return Reject(error, QString("tick %0 is not in the recording").arg(tick));
+    }
+
+    const Keyframe& keyframe = *( std::upper_bound(m_keyframes.begin(), m_keyframes.end(), tick, [](quint64 value, const Keyframe& candidate){
+        return value < candidate.tick;
+    }) - 1 );
+
+    const quint64 keyframeSize = Read<quint64>(m_bytes + keyframe.offset + 16);
+    QString message;
+    if(keyframeSize > m_size - keyframe.offset - RecordHeaderSize){
+        return Reject(error, QString("keyframe at tick %0 is cut short").arg(keyframe.tick));
+    }
+    if(!Snapshot::Read(m_bytes + keyframe.offset + RecordHeaderSize, keyframeSize, engine, &message)){
+        return Reject(error, QString("keyframe at tick %0: %1").arg(keyframe.tick).arg(message));
+    }
+
+    quint64 position = keyframe.offset + RecordHeaderSize + keyframeSize;
+    while(m_size - position >= RecordHeaderSize){
+        const quint32 type = Read<quint32>(m_bytes + position);
+        const quint64 recordTick = Read<quint64>(m_bytes + position + 8);
+        const quint64 size = Read<quint64>(m_bytes + position + 16);
+        if(size > m_size - position - RecordHeaderSize || type == INDEX || recordTick > tick) break;
+        if(type == DELTA && !ApplyDelta(m_bytes + position + RecordHeaderSize, size, engine)){
+            return Reject(error, QString("delta at tick %0 is corrupt").arg(recordTick));
+        }
+        position += RecordHeaderSize + size;
+    }
+
+    // Cells that were visited without changing are not recorded, so their tick parity bits are stale.
+    // Stamp every cell as done with tick instead, so none is skipped when the engine carries on from here.
+    engine.SetTickCount(tick);
+    CellGrid& cells = engine.Cells();
+    const quint8 parity = ( tick & 1 ) ? CellFlag::TICK_PARITY : 0;
+    for(int index = 0; index < cells.Count(); ++index){
+        cells.flags[index] = ( cells.flags[index] & ~CellFlag::TICK_PARITY ) | parity;
+    }
+    return true;
+}
+
+// Applies one DELTA payload to the engine, reading each entry's unchanged fields from the cell as it is.
+bool Replay::ApplyDelta(const uchar* payload, quint64 size, Engine& engine){
+    const CellGrid& cells = engine.Cells();
+    const quint64 cellCount = static_cast<quint64>(cells.Count());
+    const uchar* const end = payload + size;
+    quint64 nextIndex = 0;
+    for(const uchar* entry = payload; entry < end; ){
+        quint64 gap = 0;
+        for(int shift = 0; ; shift += 7){
+            if(entry == end || shift > 28) return false;
+            const uchar byte = *entry++;
+            gap |= static_cast<quint64>(byte & 0x7f) << shift;
+            if(( byte & 0x80 ) == 0) break;
+        }
+        const quint64 index = nextIndex + gap;
+        if(index >= cellCount || entry == end) return false;
+        nextIndex = index + 1;
+
+        const quint8 mask = *entry++;
+        const int fieldsSize = qPopulationCount(static_cast<quint32>(mask & ~TEMPERATURE)) + ( mask & TEMPERATURE ? 4 : 0 );
+        if(mask == 0 || mask > 0x1f || end - entry < fieldsSize) return false;
+
+        quint8 material   = cells.material[index];
+        quint8 density    = cells.density[index];
+        qint8 velocity    = cells.velocity[index];
+        quint8 flags      = cells.flags[index];
+        float temperature = cells.temperature[index];
+        if(mask & MATERIAL){
+            material = *entry++;
+            if(material >= Mat::MaterialCount) return false;
+        }
+        if(mask & DENSITY){
+            density = *entry++;
+        }
+        if(mask & VELOCITY){
+            velocity = static_cast<qint8>(*entry++);
+        }
+        if(mask & FLAGS){
+            flags = *entry++;
+        }
+        if(mask & TEMPERATURE){
+            const quint32 bits = Read<quint32>(entry);
+            std::memcpy(&temperature, &bits, sizeof(temperature));
+            entry += sizeof(bits);
+        }
+        engine.WriteCell(static_cast<int>(index), material, density, temperature, velocity, flags);
+    }
+    return true;
+}
+
+// Returns whether the file at path starts like a recording.
+bool Replay::IsRecording(const QString& path){
+    QFile file(path);
+    char magic[sizeof(Magic)];
+    return file.open(QIODevice::ReadOnly)
+        && file.read(magic, sizeof(magic)) == static_cast<qint64>(sizeof(magic))
+        && std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
@@ -0,0 +1,179 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class CellGrid;
+class Engine;
+
+// A recorded run: a keyframe of the whole world, then for every tick only the cells that changed in it,
+// with a fresh keyframe every keyframeInterval ticks so any tick can be reached without re-simulating.
+//
+// Layout, all little-endian, only ever appended to while recording:
+//   File header  magic "PPEREC\0\0", version, keyframe interval
+//   Records      a 24 byte header (type, tick, payload size), then the payload
+//     KEYFRAME   a Snapshot of the world after tick
+//     DELTA      one entry per cell that changed during tick, in index order: the gap from the previous entry's index
+//                as a varint, a mask of the changed fields, then those fields as they were after tick
+//     INDEX      (tick, file offset) of every keyframe, written by Recorder::Finish
+//   Tail         offset of the INDEX record, last tick and magic "PPERTAIL", written by Recorder::Finish
+// A recording cut short by a crash has no tail; Replay then finds the keyframes by walking the records.
+// The tick parity bit of CellGrid::flags is not recorded; it only says which tick last visited a cell.
+namespace Recording{
+
+    // Newest format version written by Recorder. Replay rejects anything newer.
+    constexpr quint32 Version = 1;
+
+    constexpr int DefaultKeyframeInterval = 256;
+
+}
+
+// Writes a Recording of an engine as it runs. Changed cells are flagged in a bitset by the engine's own Swap and SetTile,
+// so a tick costs a scan of the flagged blocks of that bitset instead of a diff of the whole grid.
+// Only those cells are compared against a copy of the last recorded state to find the fields that really changed.
+class Recorder
+{
+
+public:
+
+    Recorder();
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Starts recording into path with a keyframe of the engine's current state, and attaches to the engine so
+    // every following tick is recorded. The engine must outlive the recording, or Finish be called first.
+    // Returns false and describes the problem in error if it cannot.
+    bool Start(const QString& path, Engine& engine, int keyframeInterval = Recording::DefaultKeyframeInterval, QString* error = nullptr);
+
+    // Writes the keyframe index, detaches from the engine and closes the file. Returns false and describes the
+    // problem in error if this or any earlier write failed.
+    bool Finish(QString* error = nullptr);
+
+    bool IsRecording() const;
+
+    // Records that the cell at index changed. Called by the engine, from any update thread.
+    // Cells usually move more than once a tick, so the locked writes are skipped when the bit is already set.
+    void Touch(int index){
+        std::atomic<quint64>& word = m_changed[index >> 6];
+        const quint64 bit = quint64(1) << ( index & 63 );
+        if(( word.load(std::memory_order_relaxed) & bit ) == 0){
+            word.fetch_or(bit, std::memory_order_relaxed);
+            std::atomic<quint8>& block = m_changedBlocks[index >> CellsPerBlockShift];
+            if(block.load(std::memory_order_relaxed) == 0){
+                block.store(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Writes what changed during the tick the engine just finished. Called by the engine.
+    void EndTick(const Engine& engine);
+
+    // Forgets the changes collected so far and makes the next tick a keyframe. Called by the engine whenever
+    // its world is resized or rewritten wholesale.
+    void Reset(int cellCount);
+
+protected:
+
+    bool WriteRecord(quint32 type, quint64 tick, const char* payload, qint64 size);
+
+    bool WriteKeyframe(const Engine& engine);
+
+    bool WriteDelta(const Engine& engine);
+
+    uchar* EncodeCell(const CellGrid& cells, int index, int& nextIndex, uchar* entry);
+
+    int BlockCount() const;
+
+    void ClearChanged();
+
+    // Stops recording after a failed write, keeping the first error for Finish.
+    void Fail(const QString& error);
+
+protected:
+
+    // Cells of m_changed summarised by one flag of m_changedBlocks, so WriteDelta skips quiet regions in one load.
+    static constexpr int CellsPerBlockShift = 12;
+    static constexpr int CellsPerBlock      = 1 << CellsPerBlockShift;
+    static constexpr int WordsPerBlock      = CellsPerBlock / 64;
+
+    struct Keyframe{
+        quint64 tick;
+        quint64 offset;
+    };
+
+    QFile m_file;
+    Engine* m_engine;
+    int m_keyframeInterval;
+    bool m_keyframePending;
+    quint64 m_lastKeyframeTick;
+    quint64 m_lastTick;
+    QVector<Keyframe> m_keyframes;
+    QString m_error;
+
+    int m_cellCount;
+    std::unique_ptr<std::atomic<quint64>[]> m_changed;       // One bit per cell, set since the last record
+    std::unique_ptr<std::atomic<quint8>[]>  m_changedBlocks; // One flag per CellsPerBlock cells of m_changed with any bit set
+    std::vector<quint64> m_previous;                         // Every cell as of the last record, packed by PackCell
+    QByteArray m_delta;                                      // Reused between ticks
+};
+
+// Reads a Recording back and puts an engine in the state of any recorded tick: the nearest keyframe at or before it
+// is loaded like a Snapshot and the deltas after it are applied, without simulating anything.
+class Replay
+{
+
+public:
+
+    Replay();
+
+    Replay(const Replay&) = delete;
+    Replay& operator=(const Replay&) = delete;
+
+    // Maps the recording at path and finds its keyframes. Returns false and describes the problem in error if it cannot.
+    bool Open(const QString& path, QString* error = nullptr);
+
+    // First and last tick that Seek can reach.
+    quint64 FirstTick() const;
+    quint64 LastTick() const;
+
+    int KeyframeCount() const;
+
+    // Replaces the engine's world with the one recorded after tick, and sets its tick count and seed to match.
+    // Returns false and describes the problem in error if tick was not recorded or the recording is corrupt.
+    bool Seek(quint64 tick, Engine& engine, QString* error = nullptr);
+
+    // Returns whether the file at path starts like a recording.
+    static bool IsRecording(const QString& path);
+
+protected:
+
+    // Finds the keyframes by walking every record, for recordings without an index.
+    void ScanRecords();
+
+    // Applies one DELTA payload to the engine. Returns false if an entry is out of range.
+    bool ApplyDelta(const uchar* payload, quint64 size, Engine& engine);
+
+protected:
+
+    struct Keyframe{
+        quint64 tick;
+        quint64 offset;
+    };
+
+    QFile m_file;
+    QByteArray m_contents; // Only used where the file cannot be mapped
+    const uchar* m_bytes;
+    quint64 m_size;
+    QVector<Keyframe> m_keyframes;
+    quint64 m_lastTick;
+};
+
+#endif // RECORDING_H
@@ -0,0 +1,294 @@
+#include "Elements.h"
+#include "Engine.h"
+#include "CellGrid.h"
+#include "UpdateContext.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define PPE_ROW_KERNEL_SSE2
+#endif
+
+namespace{
+
+    static_assert(Mat::Material::EMPTY == 0, "the row kernels test for EMPTY by comparing material bytes with zero");
+
+    // Cells decided at once. One SSE2 register of material or density bytes.
+    constexpr int BlockWidth = 16;
+
+    // Which cells of a block move this tick and where to. Bit i is the cell i to the right of the block's first cell.
+    struct MoveMasks{
+        quint32 fall;    // Straight down into something less dense
+        quint32 left;    // Diagonally down-left into something less dense, past an empty cell on the left
+        quint32 right;   // Diagonally down-right into something less dense, past an empty cell on the right
+        quint32 stopped; // Not falling, but with speed left over from when it was
+        quint32 skipped; // Already updated or moved this tick, by another chunk or a neighbouring phase, so left alone
+    };
+
+    // The masks decided one cell at a time. Reference for the vector version, and used where it cannot be:
+    // blocks touching the world's left or right edge, the ends of a span, and builds without SSE2.
+    // Like the per-cell pass, stamps every cell of the material with parity, the tick's CellFlag::TICK_PARITY, and
+    // skips those that already carried it.
+    template<quint8 Material, quint8 Density, bool Slides>
+    MoveMasks ScalarMasks(CellGrid& cells, int x, int y, int count, quint8 parity){
+        MoveMasks masks = { 0, 0, 0, 0, 0 };
+        const int width = cells.Width();
+        const quint8* row      = cells.material + cells.Index(0, y);
+        const qint8*  velocity = cells.velocity + cells.Index(0, y);
+        quint8*       flags    = cells.flags    + cells.Index(0, y);
+        const quint8* below    = cells.density  + cells.Index(0, y + 1);
+        for(int i = 0; i < count; ++i){
+            const int cellX = x + i;
+            if(row[cellX] != Material) continue;
+            if(( flags[cellX] & CellFlag::TICK_PARITY ) == parity){
+                masks.skipped |= 1u << i;
+                continue;
+            }
+            flags[cellX] = ( flags[cellX] & ~CellFlag::TICK_PARITY ) | parity;
+            if(below[cellX] < Density){
+                masks.fall |= 1u << i;
+                continue;
+            }
+            if(velocity[cellX] != 0){
+                masks.stopped |= 1u << i;
+            }
+            if(Slides){
+                if(cellX > 0 && row[cellX - 1] == Mat::Material::EMPTY && below[cellX - 1] < Density){
+                    masks.left |= 1u << i;
+                }
+                if(cellX + 1 < width && row[cellX + 1] == Mat::Material::EMPTY && below[cellX + 1] < Density){
+                    masks.right |= 1u << i;
+                }
+            }
+        }
+        return masks;
+    }
+
+#ifdef PPE_ROW_KERNEL_SSE2
+    // SSE2 has no unsigned byte compare, but Density - value saturates to zero exactly when value >= Density.
+    inline __m128i LessDense(__m128i density, const quint8* values){
+        const __m128i difference = _mm_subs_epu8(density, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values)));
+        return _mm_xor_si128(_mm_cmpeq_epi8(difference, _mm_setzero_si128()), _mm_set1_epi8(-1));
+    }
+
+    inline __m128i IsEmpty(const quint8* materials){
+        return _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(materials)), _mm_setzero_si128());
+    }
+
+    // Same masks and stamps as ScalarMasks for a full block. The block and one cell either side of it must be in the world.
+    template<quint8 Material, quint8 Density, bool Slides>
+    MoveMasks VectorMasks(CellGrid& cells, int x, int y, quint8 parity){
+        const quint8* row      = cells.material + cells.Index(x, y);
+        const qint8*  velocity = cells.velocity + cells.Index(x, y);
+        quint8*       flags    = cells.flags    + cells.Index(x, y);
+        const quint8* below    = cells.density  + cells.Index(x, y + 1);
+        const __m128i density = _mm_set1_epi8(static_cast<char>(Density));
+
+        const __m128i isMaterial = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)), _mm_set1_epi8(static_cast<char>(Material)));
+        if(_mm_movemask_epi8(isMaterial) == 0){
+            return { 0, 0, 0, 0, 0 };
+        }
+
+        const __m128i parityBit  = _mm_set1_epi8(static_cast<char>(CellFlag::TICK_PARITY));
+        const __m128i parities   = _mm_set1_epi8(static_cast<char>(parity));
+        const __m128i flagBytes  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(flags));
+        const __m128i stamped    = _mm_and_si128(isMaterial, _mm_cmpeq_epi8(_mm_and_si128(flagBytes, parityBit), parities));
+        const __m128i fresh      = _mm_andnot_si128(stamped, isMaterial);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(flags),
+                         _mm_or_si128(_mm_andnot_si128(_mm_and_si128(isMaterial, parityBit), flagBytes), _mm_and_si128(isMaterial, parities)));
+
+        const __m128i falls      = _mm_and_si128(fresh, LessDense(density, below));
+        const __m128i rests      = _mm_andnot_si128(falls, fresh);
+        const __m128i still      = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(velocity)), _mm_setzero_si128());
+
+        MoveMasks masks = { static_cast<quint32>(_mm_movemask_epi8(falls)), 0, 0,
+                            static_cast<quint32>(_mm_movemask_epi8(_mm_andnot_si128(still, rests))),
+                            static_cast<quint32>(_mm_movemask_epi8(stamped)) };
+        if constexpr (Slides){
+            const __m128i leftOpen  = _mm_and_si128(IsEmpty(row - 1), LessDense(density, below - 1));
+            const __m128i rightOpen = _mm_and_si128(IsEmpty(row + 1), LessDense(density, below + 1));
+            masks.left  = static_cast<quint32>(_mm_movemask_epi8(_mm_and_si128(rests, leftOpen)));
+            masks.right = static_cast<quint32>(_mm_movemask_epi8(_mm_and_si128(rests, rightOpen)));
+        }
+        return masks;
+    }
+#endif
+
+    // Sends cells that could slide either way in the direction of their random bit, one bit per cell, then keeps two cells
+    // from sliding into the same one: x sliding right and x + 2 sliding left both land on x + 1, the left slide wins.
+    void ResolveSlides(MoveMasks& masks, quint32 randomBits){
+        const quint32 both = masks.left & masks.right;
+        masks.left  &= ~( both &  randomBits );
+        masks.right &= ~( both & ~randomBits );
+        masks.right &= ~( masks.left >> 2 );
+    }
+
+    // Applies the moves of a block. No two moves share a cell, so the order does not matter.
+    // A fall into an empty cell carries on down to the FallDestination of the cell's speed, marked on its own.
+    // Returns how many rows the falls covered.
+    int ApplyMoves(UpdateContext& context, Engine& engine, CellGrid& cells, const MoveMasks& masks, int x, int y){
+        int distance = 0;
+        for(quint32 bits = masks.fall; bits != 0; bits &= bits - 1){
+            const int cellX = x + qCountTrailingZeroBits(bits);
+            const int index = cells.Index(cellX, y);
+            int toY = y + 1;
+            if(cells.material[cells.Index(cellX, toY)] == Mat::Material::EMPTY){
+                const int speed = FallSpeed(cells.velocity[index]);
+                toY = FallDestination(context, cellX, y, speed);
+                cells.velocity[index] = static_cast<qint8>(-speed);
+            }else{
+                cells.velocity[index] = -1; // sinking through something lighter, a cell at a time
+            }
+            cells.flags[index] &= ~CellFlag::HEADING_MASK;
+            engine.SwapUnmarked(cellX, y, cellX, toY);
+            if(toY > y + 1){
+                engine.MarkRegion(cellX, toY, cellX, toY);
+            }
+            distance += toY - y;
+        }
+
+        // A skipped cell has moved this tick already, as in the per-cell pass, and carries on on the next one.
+        for(quint32 bits = masks.skipped; bits != 0; bits &= bits - 1){
+            engine.MarkDirty(x + qCountTrailingZeroBits(bits), y);
+        }
+
+        // Cells that have landed lose their speed, unless they slide off.
+        for(quint32 bits = masks.stopped & ~( masks.left | masks.right ); bits != 0; bits &= bits - 1){
+            const int index = cells.Index(x + qCountTrailingZeroBits(bits), y);
+            cells.velocity[index] = 0;
+            engine.TouchCell(index);
+        }
+
+        auto Move = [&](quint32 bits, int dx, quint8 heading){
+            while(bits != 0){
+                const int cellX = x + qCountTrailingZeroBits(bits);
+                bits &= bits - 1;
+
+                const int index = cells.Index(cellX, y);
+                cells.flags[index] = ( cells.flags[index] & ~CellFlag::HEADING_MASK ) | heading;
+                cells.velocity[index] = -1; // falling, as DeltaVelocityDueToGravity records for a diagonal move off a landing
+                engine.SwapUnmarked(cellX, y, cellX + dx, y + 1);
+            }
+        };
+        Move(masks.left,  -1, CellFlag::HEADING_LEFT);
+        Move(masks.right,  1, CellFlag::HEADING_RIGHT);
+
+        const quint32 moved = masks.fall | masks.left | masks.right;
+        if(moved != 0){
+            const int first = qCountTrailingZeroBits(moved);
+            const int last  = 31 - qCountLeadingZeroBits(moved);
+            engine.MarkRegion(x + first - 1, y, x + last + 1, y + 1);
+        }
+        return distance;
+    }
+
+    // The row kernel for one material, with its traits resolved at compile time. Does nothing for non-powders.
+    // Returns how many cells it skipped. The counters are added up from the masks' popcounts and counted once a row.
+    template<Mat::Material M>
+    int PowderRow(UpdateContext& context, int y, int left, int right){
+        constexpr Mat::Traits traits = Mat::TraitsOf(M);
+        if constexpr (traits.movement == Mat::Movement::POWDER){
+            constexpr bool slides = traits.friction < 0.5;
+            Engine& engine  = *context.engine;
+            CellGrid& cells = engine.Cells();
+            const quint8 parity = engine.TickParity();
+            int skipped  = 0;
+            int falls    = 0;
+            int slid     = 0;
+            int distance = 0;
+
+            for(int x = left; x <= right; x += BlockWidth){
+                const int count = std::min(BlockWidth, right - x + 1);
+                MoveMasks masks;
+#ifdef PPE_ROW_KERNEL_SSE2
+                if(count == BlockWidth && x > 0 && x + BlockWidth < cells.Width()){
+                    masks = VectorMasks<M, traits.density, slides>(cells, x, y, parity);
+                }else{
+                    masks = ScalarMasks<M, traits.density, slides>(cells, x, y, count, parity);
+                }
+#else
+                masks = ScalarMasks<M, traits.density, slides>(cells, x, y, count, parity);
+#endif
+                if constexpr (slides){
+                    ResolveSlides(masks, context.random.Next());
+                }
+                distance += ApplyMoves(context, engine, cells, masks, x, y);
+                falls    += qPopulationCount(masks.fall);
+                slid     += qPopulationCount(masks.left | masks.right);
+                skipped  += qPopulationCount(masks.skipped);
+            }
+            PPE_COUNT(context, CELLS_UPDATED,    falls + slid);
+            PPE_COUNT(context, GRAVITY_SWAPS,    falls);
+            PPE_COUNT(context, GRAVITY_DISTANCE, distance);
+            PPE_COUNT(context, SPREAD_SWAPS,     slid);
+#ifndef PPE_ENABLE_COUNTERS
+            Q_UNUSED(falls);
+            Q_UNUSED(slid);
+            Q_UNUSED(distance);
+#endif
+            return skipped;
+        }else{
+            Q_UNUSED(context);
+            Q_UNUSED(y);
+            Q_UNUSED(left);
+            Q_UNUSED(right);
+            return 0;
+        }
+    }
+
+    template<size_t... Materials>
+    int PowderRows(UpdateContext& context, int y, int left, int right, std::index_sequence<Materials...>){
+        return ( PowderRow<static_cast<Mat::Material>(Materials)>(context, y, left, right) + ... );
+    }
+
+    // Decides the block at x, y with ScalarMasks and then, from the same flags, with VectorMasks, and returns whether
+    // both give the same masks and stamps. True for non-powders, and without SSE2 where there is nothing to compare.
+    template<Mat::Material M>
+    bool MasksAgree(CellGrid& cells, int x, int y, quint8 parity){
+        constexpr Mat::Traits traits = Mat::TraitsOf(M);
+#ifdef PPE_ROW_KERNEL_SSE2
+        if constexpr (traits.movement == Mat::Movement::POWDER){
+            constexpr bool slides = traits.friction < 0.5;
+            quint8* flags = cells.flags + cells.Index(x, y);
+            std::array<quint8, BlockWidth> before;
+            std::array<quint8, BlockWidth> scalarFlags;
+            std::copy(flags, flags + BlockWidth, before.begin());
+            const MoveMasks scalar = ScalarMasks<M, traits.density, slides>(cells, x, y, BlockWidth, parity);
+            std::copy(flags, flags + BlockWidth, scalarFlags.begin());
+            std::copy(before.begin(), before.end(), flags);
+            const MoveMasks vector = VectorMasks<M, traits.density, slides>(cells, x, y, parity);
+            return scalar.fall == vector.fall && scalar.left == vector.left && scalar.right == vector.right
+                && scalar.stopped == vector.stopped && scalar.skipped == vector.skipped
+                && std::equal(scalarFlags.begin(), scalarFlags.end(), flags);
+        }
+#endif
+        Q_UNUSED(traits);
+        Q_UNUSED(cells);
+        Q_UNUSED(x);
+        Q_UNUSED(y);
+        Q_UNUSED(parity);
+        return true;
+    }
+
+    template<size_t... Materials>
+    bool AllMasksAgree(CellGrid& cells, int x, int y, quint8 parity, std::index_sequence<Materials...>){
+        return ( MasksAgree<static_cast<Mat::Material>(Materials)>(cells, x, y, parity) && ... );
+    }
+
+}
+
+// Moves every powder cell of row y between left and right (inclusive) one step, 16 cells at a time.
+// Returns how many it skipped because they had already been updated or moved this tick.
+int UpdatePowderRow(UpdateContext& context, int y, int left, int right){
+    // The bottom row has nowhere to go.
+    if(y + 1 >= context.engine->Height()) return 0;
+    return PowderRows(context, y, left, right, std::make_index_sequence<Mat::MaterialCount>());
+}
+
+// Decides the 16 cells from x on row y with the scalar and the SSE2 masks for every powder, and compares them.
+bool PowderMasksAgree(CellGrid& cells, int x, int y, quint8 parity){
+    return AllMasksAgree(cells, x, y, parity, std::make_index_sequence<Mat::MaterialCount>());
+}
@@ -0,0 +1,103 @@
+#include "Scenario.h"
+#include "Engine.h"
+#include "Elements.h"
+#include <QFile>
+#include <QMetaEnum>
+#include <QRect>
+#include <QStringList>
+#include <algorithm>
+
+namespace{
+
+    bool Fail(QString* error, int lineNumber, const QString& message){
+        if(error != nullptr){
+            *error = QString("line %0: %1").arg(lineNumber).arg(message);
+        }
+        return false;
+    }
+
+    // Parses every argument after the command as an integer.
+    bool ToInts(const QStringList& words, QVector<int>& values){
+        values.clear();
+        for(int i = 1; i < words.size(); ++i){
+            bool ok = false;
+            values.append(words[i].toInt(&ok));
+            if(!ok) return false;
+        }
+        return true;
+    }
+
+}
+
+// Loads the scenario at path into engine. Returns false and describes the problem in error if it cannot.
+bool Scenario::Load(const QString& path, Engine& engine, QString* error){
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)){
+        if(error != nullptr){
+            *error = QString("%0: %1").arg(path).arg(file.errorString());
+        }
+        return false;
+    }
+    return Parse(QString::fromUtf8(file.readAll()), engine, error);
+}
+
+// Same as Load, but reads the commands from text instead of a file.
+bool Scenario::Parse(const QString& text, Engine& engine, QString* error){
+    const QMetaEnum materialMetaEnum = QMetaEnum::fromType<Mat::Material>();
+    const QStringList lines = text.split('\n');
+    bool sized = false;
+    QVector<int> values;
+
+    for(int lineIndex = 0; lineIndex < lines.size(); ++lineIndex){
+        const int lineNumber = lineIndex + 1;
+        const QString line = lines[lineIndex].section('#', 0, 0).trimmed();
+        if(line.isEmpty()) continue;
+
+        const QStringList words = line.split(' ', Qt::SkipEmptyParts);
+        const QString& command = words.first();
+
+        if(command == "size"){
+            if(words.size() != 3 || !ToInts(words, values) || values[0] <= 0 || values[1] <= 0){
+                return Fail(error, lineNumber, "expected: size <width> <height>");
+            }
+            engine.ResizeTiles(values[0], values[1]);
+            sized = true;
+        }else if(command == "rect"){
+            if(!sized){
+                return Fail(error, lineNumber, "rect before size");
+            }
+            bool isMaterial = false;
+            const int material = words.size() > 1 ? materialMetaEnum.keyToValue(words[1].toLatin1().constData(), &isMaterial) : 0;
+            if(!isMaterial){
+                return Fail(error, lineNumber, "unknown material");
+            }
+            if(words.size() != 6 || !ToInts(words.mid(1), values)){
+                return Fail(error, lineNumber, "expected: rect <MATERIAL> <x> <y> <width> <height>");
+            }
+            engine.FillRect(QRect(values[0], values[1], values[2], values[3]), static_cast<Mat::Material>(material));
+        }else if(command == "heat"){
+            if(!sized){
+                return Fail(error, lineNumber, "heat before size");
+            }
+            if(words.size() != 6 || !ToInts(words, values)){
+                return Fail(error, lineNumber, "expected: heat <x> <y> <width> <height> <celsius>");
+            }
+            engine.SetTemperature(QRect(values[0], values[1], values[2], values[3]), values[4]);
+        }else if(command == "fire"){
+            if(!sized){
+                return Fail(error, lineNumber, "fire before size");
+            }
+            if(words.size() != 5 || !ToInts(words, values)){
+                return Fail(error, lineNumber, "expected: fire <x> <y> <width> <height>");
+            }
+            engine.Ignite(QRect(values[0], values[1], values[2], values[3]));
+        }else{
+            return Fail(error, lineNumber, QString("unknown command '%0'").arg(command));
+        }
+    }
+
+    if(!sized){
+        return Fail(error, lines.size(), "missing size");
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <QString>
+
+class Engine;
+
+// Plain text description of a starting world, used to set up headless runs.
+// One command per line, blank lines and anything after '#' are ignored:
+//   size <width> <height>                    Resizes and clears the world. Must come before any fill.
+//   rect <MATERIAL> <x> <y> <width> <height>  Fills a rectangle, MATERIAL is a Mat::Material key such as SAND.
+//   heat <x> <y> <width> <height> <celsius>   Sets the temperature of a rectangle. Fills after it reset it to ambient.
+//   fire <x> <y> <width> <height>             Sets alight the flammable cells of a rectangle, such as WOOD.
+namespace Scenario{
+
+    // Loads the scenario at path into engine. Returns false and describes the problem in error if it cannot.
+    bool Load(const QString& path, Engine& engine, QString* error = nullptr);
+
+    // Same as Load, but reads the commands from text instead of a file.
+    bool Parse(const QString& text, Engine& engine, QString* error = nullptr);
+
+}
+
+#endif // SCENARIO_H
@@ -0,0 +1,217 @@
+#include "SimulationThread.h"
+#include "Engine.h"
+#include "Trace.h"
+#include <algorithm>
+#include <future>
+
+SimulationThread::SimulationThread(Engine& engine) :
+    m_engine(engine)
+  , m_stopping(false)
+  , m_running(false)
+  , m_focus(-1, -1)
+{
+}
+
+SimulationThread::~SimulationThread(){
+    Stop();
+}
+
+// Starts stepping the engine as scheduled by a TickScheduler.
+void SimulationThread::Start(){
+    if(m_running.load()){
+        return;
+    }
+    m_stopping = false;
+    m_running.store(true);
+    m_thread = std::thread(&SimulationThread::Loop, this);
+}
+
+// Runs the commands still queued and stops the thread.
+void SimulationThread::Stop(){
+    if(!m_running.load()){
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+    m_thread.join();
+    m_running.store(false);
+    RunCommands();
+}
+
+bool SimulationThread::IsRunning() const{
+    return m_running.load();
+}
+
+// Scheduler settings, applied between ticks like a posted command.
+void SimulationThread::SetTickRate(double ticksPerSecond){
+    Post([this, ticksPerSecond](Engine&){ m_scheduler.SetTickRate(ticksPerSecond); });
+}
+
+void SimulationThread::SetFrameBudget(double milliseconds){
+    Post([this, milliseconds](Engine&){ m_scheduler.SetFrameBudget(milliseconds); });
+}
+
+void SimulationThread::SetCatchUp(TickScheduler::CatchUp catchUp){
+    Post([this, catchUp](Engine&){
+        m_scheduler.SetCatchUp(catchUp);
+        ApplyRegionScale();
+    });
+}
+
+// Where the updated region is centred while catching up by shrinking it.
+void SimulationThread::SetFocus(const QPoint& focus){
+    Post([this, focus](Engine&){ m_focus = focus; });
+}
+
+// The scheduler's measurements as of the last frame.
+TickScheduler::Statistics SimulationThread::Statistics(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+// Queues command to be run on the engine between two ticks.
+void SimulationThread::Post(std::function<void(Engine&)> command){
+    if(!m_running.load()){
+        command(m_engine);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_commands.push_back(std::move(command));
+    }
+    m_wakeCondition.notify_all();
+}
+
+// Same as Post, but waits for command to have run.
+void SimulationThread::Invoke(const std::function<void(Engine&)>& command){
+    if(!m_running.load()){
+        command(m_engine);
+        return;
+    }
+    std::promise<void> done;
+    std::future<void> doneFuture = done.get_future();
+    Post([&command, &done](Engine& engine){
+        command(engine);
+        done.set_value();
+    });
+    doneFuture.wait();
+}
+
+// Returns the newest Frame published since the last call, or nullptr if there is none.
+const Frame* SimulationThread::TakeFrame(){
+    return m_frames.Take() ? &m_frames.Front() : nullptr;
+}
+
+void SimulationThread::Loop(){
+    Trace::SetThreadName("Simulation");
+
+    // The first frame shows the world as it was handed over.
+    RunCommands();
+    PublishFrame();
+    m_scheduler.Reset();
+
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait_until(lock, m_scheduler.NextTick(), [this]{ return m_stopping || !m_commands.empty(); });
+            if(m_stopping){
+                return;
+            }
+        }
+
+        // Edits show up as soon as they are made, not only with the next tick.
+        bool changed = RunCommands();
+        if(TickScheduler::Clock::now() >= m_scheduler.NextTick()){
+            changed |= m_scheduler.RunFrame([this]{ m_engine.Step(); }) > 0;
+            ApplyRegionScale();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_statistics = m_scheduler.Stats();
+        }
+        if(changed){
+            PublishFrame();
+        }
+    }
+}
+
+// Runs and removes every queued command.
+bool SimulationThread::RunCommands(){
+    std::vector<std::function<void(Engine&)>> commands;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        commands.swap(m_commands);
+    }
+    if(commands.empty()){
+        return false;
+    }
+
+    PPE_TRACE_ZONE("Commands");
+    for(const std::function<void(Engine&)>& command : commands){
+        command(m_engine);
+    }
+    return true;
+}
+
+// Limits the engine's updates to the part of the world around m_focus that the scheduler's RegionScale allows.
+void SimulationThread::ApplyRegionScale(){
+    const double scale = m_scheduler.RegionScale();
+    if(scale >= 1.0 || m_engine.Width() == 0 || m_engine.Height() == 0){
+        m_engine.SetUpdateRegion(QRect());
+        return;
+    }
+    const int width  = std::max(static_cast<int>(m_engine.Width()  * scale), 1);
+    const int height = std::max(static_cast<int>(m_engine.Height() * scale), 1);
+    const QPoint focus = QRect(0, 0, m_engine.Width(), m_engine.Height()).contains(m_focus) ? m_focus
+                       : QPoint(m_engine.Width() / 2, m_engine.Height() / 2);
+    const int left = std::clamp(focus.x() - width  / 2, 0, m_engine.Width()  - width);
+    const int top  = std::clamp(focus.y() - height / 2, 0, m_engine.Height() - height);
+    m_engine.SetUpdateRegion(QRect(left, top, width, height));
+}
+
+// Renders the cells changed since the back frame was last written into it and publishes it.
+// Every slot misses what changed since it was last rendered, which for the one the consumer holds can be many ticks.
+// The frame also lists everything changed since the frame the consumer may still be showing, so it can repaint only that.
+void SimulationThread::PublishFrame(){
+    PPE_TRACE_ZONE("PublishFrame");
+    const QRect world(0, 0, m_engine.Width(), m_engine.Height());
+    QVector<QRect> changedRects = m_engine.TakeChangedRects();
+    for(QVector<QRect>& staleRects : m_staleRects){
+        if(staleRects.size() + changedRects.size() > MaxStaleRects){
+            staleRects = { world };
+        }else{
+            staleRects += changedRects;
+        }
+    }
+
+    Frame& frame = m_frames.Back();
+    QVector<QRect>& staleRects = m_staleRects[m_frames.BackIndex()];
+    uchar* bits = reinterpret_cast<uchar*>(frame.pixels.data());
+    const int bytesPerLine = m_engine.Width() * static_cast<int>(sizeof(quint32));
+    if(frame.width != m_engine.Width() || frame.height != m_engine.Height()){
+        frame.width  = m_engine.Width();
+        frame.height = m_engine.Height();
+        frame.pixels.resize(static_cast<size_t>(frame.width) * frame.height);
+        bits = reinterpret_cast<uchar*>(frame.pixels.data());
+        m_engine.RenderColors(bits, bytesPerLine);
+        changedRects = { world };
+    }else{
+        for(const QRect& rect : staleRects){
+            m_engine.RenderColors(bits, bytesPerLine, rect);
+        }
+    }
+    staleRects.clear();
+
+    if(m_untakenRects.size() + changedRects.size() > MaxStaleRects){
+        frame.changedRects = { world };
+    }else{
+        frame.changedRects = m_untakenRects + changedRects;
+    }
+    frame.tick = m_engine.TickCount();
+    frame.counters = m_engine.LastTickCounters();
+
+    // Once the frame before this one was taken, the next frame only has to cover what changed in this one.
+    const QVector<QRect> publishedRects = frame.changedRects;
+    m_untakenRects = m_frames.Publish() ? changedRects : publishedRects;
+}
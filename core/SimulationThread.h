@@ -0,0 +1,111 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+#include "Counters.h"
+#include "TickScheduler.h"
+#include "TripleBuffer.h"
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Engine;
+
+// The world as it looked after a tick, rendered for display.
+struct Frame{
+    int width  = 0;
+    int height = 0;
+    quint64 tick = 0;
+    std::vector<quint32> pixels; // 0xAARRGGBB per cell, width per row, as Engine::RenderColors writes them
+    QVector<QRect> changedRects; // Where the pixels differ from the frame TakeFrame returned before, the whole world after a resize
+    TickCounters counters;       // Engine::LastTickCounters as of tick
+};
+
+// Steps an engine on a thread of its own so a slow tick never holds up the UI and a slow paint never holds up
+// the simulation. Nothing else may touch the engine while the thread runs: edits are queued with Post and applied
+// between ticks, and the world is read back as the Frames the thread publishes after every tick or edit.
+class SimulationThread
+{
+
+public:
+
+    explicit SimulationThread(Engine& engine);
+
+    // Stops the thread.
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Starts stepping the engine as scheduled by a TickScheduler. Commands posted before are run first.
+    void Start();
+
+    // Runs the commands still queued and stops the thread. The engine may be used directly again afterwards.
+    void Stop();
+
+    bool IsRunning() const;
+
+    // Scheduler settings, see TickScheduler. Applied between ticks like a posted command.
+    void SetTickRate(double ticksPerSecond);
+    void SetFrameBudget(double milliseconds);
+    void SetCatchUp(TickScheduler::CatchUp catchUp);
+
+    // Where the updated region is centred while catching up by TickScheduler::CatchUp::SHRINK_REGION,
+    // such as the cell under the mouse. Defaults to the middle of the world.
+    void SetFocus(const QPoint& focus);
+
+    // The scheduler's measurements as of the last frame.
+    TickScheduler::Statistics Statistics();
+
+    // Queues command to be run on the engine between two ticks, in the order posted. Runs it at once if the thread
+    // is not running.
+    void Post(std::function<void(Engine&)> command);
+
+    // Same as Post, but waits for command to have run, for callers that need its result.
+    void Invoke(const std::function<void(Engine&)>& command);
+
+    // Returns the newest Frame published since the last call, or nullptr if there is none. The frame stays valid and
+    // unchanged until the next call. Call from one thread only.
+    const Frame* TakeFrame();
+
+protected:
+
+    void Loop();
+
+    // Runs and removes every queued command. Returns whether there were any.
+    bool RunCommands();
+
+    // Renders the cells changed since the back frame was last written into it and publishes it.
+    void PublishFrame();
+
+    // Limits the engine's updates to the part of the world around m_focus that the scheduler's RegionScale allows.
+    void ApplyRegionScale();
+
+protected:
+
+    // Past this many rects the regions a frame is missing are replaced by the whole world.
+    static constexpr int MaxStaleRects = 256;
+
+    Engine& m_engine;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::vector<std::function<void(Engine&)>> m_commands;
+    bool m_stopping;
+    std::atomic<bool> m_running;
+
+    TickScheduler m_scheduler;            // Only used on the thread
+    QPoint m_focus;                       // Only used on the thread
+    TickScheduler::Statistics m_statistics; // Guarded by m_mutex
+
+    TripleBuffer<Frame> m_frames;
+    QVector<QRect> m_staleRects[3]; // Per frame slot, the regions changed since it was last rendered into
+    QVector<QRect> m_untakenRects;  // Regions changed in frames published since the one the consumer is known to hold
+};
+
+#endif // SIMULATIONTHREAD_H
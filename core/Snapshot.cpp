@@ -0,0 +1,363 @@
+#include "Snapshot.h"
+#include "Engine.h"
+#include "CellGrid.h"
+#include "Elements.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace{
+
+    const char Magic[8] = { 'P', 'P', 'E', 'S', 'N', 'A', 'P', '\0' };
+
+    // The blocks of a snapshot, in file order: every CellGrid field, then which chunks are awake.
+    enum Field{
+        MATERIAL,
+        DENSITY,
+        TEMPERATURE,
+        VELOCITY,
+        FLAGS,
+        ACTIVITY, // Engine::PendingDirtyRects as left, top, right, bottom qint32s per chunk
+        FieldCount
+    };
+
+    constexpr quint32 ElementSizes[FieldCount] = { sizeof(quint8), sizeof(quint8), sizeof(float), sizeof(qint8), sizeof(quint8), sizeof(qint32) };
+
+    constexpr int ActivityValuesPerRect = 4;
+    static_assert(sizeof(DirtyRect) == ActivityValuesPerRect * sizeof(qint32), "DirtyRect is stored as four qint32s");
+
+    enum Encoding : quint32{
+        RAW = 0, // The field exactly as CellGrid holds it
+        RLE = 1, // (quint32 run length, element) pairs
+    };
+
+    // Field blocks start on this boundary in the file, so a mapped block is as aligned as the grid's own buffers.
+    constexpr quint64 BlockAlignment = 64;
+
+    // Refuses worlds too big to be plausible. Keeps every size computed from the header far from overflowing.
+    constexpr quint64 MaxCells = quint64(1) << 28;
+
+    struct FieldEntry{
+        quint32 encoding;
+        quint32 elementSize;
+        quint64 offset; // From the start of the snapshot
+        quint64 size;   // Bytes stored in the file
+    };
+
+    struct Header{
+        char       magic[8];
+        quint32    version;
+        quint32    reserved;
+        qint32     width;
+        qint32     height;
+        quint64    seed;
+        quint64    tickCount;
+        FieldEntry fields[FieldCount];
+    };
+    static_assert(sizeof(FieldEntry) == 24 && sizeof(Header) == 184, "the header is read and written as is and must not contain padding");
+
+    quint64 AlignUp(quint64 offset){
+        return ( offset + BlockAlignment - 1 ) & ~( BlockAlignment - 1 );
+    }
+
+    // Converts every integer of the header between host and file byte order. Doing it twice undoes it.
+    void ToggleByteOrder(Header& header){
+        header.version   = qToLittleEndian(header.version);
+        header.reserved  = qToLittleEndian(header.reserved);
+        header.width     = qToLittleEndian(header.width);
+        header.height    = qToLittleEndian(header.height);
+        header.seed      = qToLittleEndian(header.seed);
+        header.tickCount = qToLittleEndian(header.tickCount);
+        for(FieldEntry& entry : header.fields){
+            entry.encoding    = qToLittleEndian(entry.encoding);
+            entry.elementSize = qToLittleEndian(entry.elementSize);
+            entry.offset      = qToLittleEndian(entry.offset);
+            entry.size        = qToLittleEndian(entry.size);
+        }
+    }
+
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    // Reverses the bytes of every element, converting a field between host and file byte order.
+    void ToggleByteOrder(uchar* data, quint64 count, quint32 elementSize){
+        for(quint64 i = 0; elementSize > 1 && i < count; ++i){
+            std::reverse(data + i * elementSize, data + ( i + 1 ) * elementSize);
+        }
+    }
+#endif
+
+    // Where the blocks live in memory: the grid's field buffers, and rects for ACTIVITY.
+    uchar* FieldData(const CellGrid& cells, std::vector<DirtyRect>& rects, int field){
+        switch(field){
+            case MATERIAL:    return cells.material;
+            case DENSITY:     return cells.density;
+            case TEMPERATURE: return reinterpret_cast<uchar*>(cells.temperature);
+            case VELOCITY:    return reinterpret_cast<uchar*>(cells.velocity);
+            case FLAGS:       return cells.flags;
+            default:          return reinterpret_cast<uchar*>(rects.data());
+        }
+    }
+
+    // Elements in a block of a width x height world.
+    quint64 ElementCount(int field, qint32 width, qint32 height){
+        if(field == ACTIVITY){
+            const quint64 chunkColumns = ( static_cast<quint64>(width)  + Engine::ChunkSize - 1 ) / Engine::ChunkSize;
+            const quint64 chunkRows    = ( static_cast<quint64>(height) + Engine::ChunkSize - 1 ) / Engine::ChunkSize;
+            return chunkColumns * chunkRows * ActivityValuesPerRect;
+        }
+        return static_cast<quint64>(width) * static_cast<quint64>(height);
+    }
+
+    bool Fail(QString* error, const QString& path, const QString& message){
+        if(error != nullptr){
+            *error = QString("%0: %1").arg(path).arg(message);
+        }
+        return false;
+    }
+
+    // Run-length encodes count elements. Gives up and returns false as soon as the encoding would reach limit bytes,
+    // since the field is then better stored RAW.
+    bool EncodeRle(const uchar* data, quint64 count, quint32 elementSize, quint64 limit, QByteArray& encoded){
+        encoded.clear();
+        quint64 i = 0;
+        while(i < count){
+            const uchar* element = data + i * elementSize;
+            const quint64 maxRun = std::min<quint64>(count - i, 0xFFFFFFFFu);
+            quint64 run = 1;
+            if(elementSize == 1){
+                run = std::find_if(element + 1, element + maxRun, [element](uchar value){ return value != *element; }) - element;
+            }else{
+                while(run < maxRun && std::memcmp(element, element + run * elementSize, elementSize) == 0){
+                    ++run;
+                }
+            }
+            if(static_cast<quint64>(encoded.size()) + sizeof(quint32) + elementSize >= limit){
+                return false;
+            }
+            const quint32 runLength = qToLittleEndian(static_cast<quint32>(run));
+            encoded.append(reinterpret_cast<const char*>(&runLength), sizeof(runLength));
+            encoded.append(reinterpret_cast<const char*>(element), elementSize);
+            i += run;
+        }
+        return true;
+    }
+
+    // Calls visit(element, first, run) for every run of an RLE block. Returns false if the block is malformed or
+    // does not decode to exactly count elements, or as soon as visit returns false.
+    template<typename Visit>
+    bool ForEachRun(const uchar* block, quint64 size, quint32 elementSize, quint64 count, Visit&& visit){
+        const quint64 pairSize = sizeof(quint32) + elementSize;
+        quint64 decoded = 0;
+        for(quint64 position = 0; position < size; position += pairSize){
+            if(size - position < pairSize) return false;
+            const quint32 run = qFromLittleEndian<quint32>(block + position);
+            if(run == 0 || run > count - decoded) return false;
+            if(!visit(block + position + sizeof(quint32), decoded, run)) return false;
+            decoded += run;
+        }
+        return decoded == count;
+    }
+
+    bool IsMaterial(uchar value){
+        return value < Mat::MaterialCount;
+    }
+
+    // Checks that an entry describes a block inside the snapshot that decodes to exactly count elements,
+    // and for the material block that every element is a known material. Touches nothing.
+    bool ValidBlock(int field, const FieldEntry& entry, const uchar* snapshot, quint64 snapshotSize, quint64 count){
+        if(entry.elementSize != ElementSizes[field]) return false;
+        if(entry.offset > snapshotSize || entry.size > snapshotSize - entry.offset) return false;
+
+        const uchar* block = snapshot + entry.offset;
+        if(entry.encoding == RAW){
+            if(entry.size != count * entry.elementSize) return false;
+            return field != MATERIAL || std::all_of(block, block + count, IsMaterial);
+        }else if(entry.encoding == RLE){
+            return ForEachRun(block, entry.size, entry.elementSize, count, [field](const uchar* element, quint64, quint32){
+                return field != MATERIAL || IsMaterial(*element);
+            });
+        }
+        return false;
+    }
+
+    // Writes a validated block to where it lives in memory.
+    void DecodeBlock(const FieldEntry& entry, const uchar* snapshot, quint64 count, uchar* data){
+        const uchar* block = snapshot + entry.offset;
+        if(entry.encoding == RAW){
+            std::memcpy(data, block, entry.size);
+        }else{
+            ForEachRun(block, entry.size, entry.elementSize, count, [&entry, data](const uchar* element, quint64 first, quint32 run){
+                uchar* target = data + first * entry.elementSize;
+                if(entry.elementSize == 1){
+                    std::memset(target, *element, run);
+                }else{
+                    for(quint32 i = 0; i < run; ++i){
+                        std::memcpy(target + i * entry.elementSize, element, entry.elementSize);
+                    }
+                }
+                return true;
+            });
+        }
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        ToggleByteOrder(data, count, entry.elementSize);
+#endif
+    }
+
+    bool WriteBlock(QIODevice& device, qint64 position, const void* data, quint64 size){
+        static const char zeros[BlockAlignment] = {};
+        const qint64 padding = position - device.pos();
+        if(padding < 0 || device.write(zeros, padding) != padding) return false;
+        return device.write(static_cast<const char*>(data), size) == static_cast<qint64>(size);
+    }
+
+}
+
+// Writes the engine's world to path, replacing the file only once it is complete.
+bool Snapshot::Save(const QString& path, const Engine& engine, Compression compression, QString* error){
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly) || !Write(file, engine, compression) || !file.commit()){
+        return Fail(error, path, file.errorString());
+    }
+    return true;
+}
+
+// Writes a snapshot of the engine's world at the device's current position.
+bool Snapshot::Write(QIODevice& device, const Engine& engine, Compression compression){
+    const CellGrid& cells = engine.Cells();
+    std::vector<DirtyRect> rects = engine.PendingDirtyRects();
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version   = Version;
+    header.width     = cells.Width();
+    header.height    = cells.Height();
+    header.seed      = engine.Seed();
+    header.tickCount = engine.TickCount();
+
+    // Encode every block first so the header can say where each one goes.
+    // A field whose entry in blocks is empty after this is written straight from memory.
+    QByteArray blocks[FieldCount];
+    quint64 offset = AlignUp(sizeof(Header));
+    for(int field = 0; field < FieldCount; ++field){
+        const quint64 count = ElementCount(field, header.width, header.height);
+        FieldEntry& entry = header.fields[field];
+        entry.elementSize = ElementSizes[field];
+        entry.encoding    = RAW;
+        entry.size        = count * entry.elementSize;
+
+        const uchar* data = FieldData(cells, rects, field);
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        QByteArray littleEndian(reinterpret_cast<const char*>(data), entry.size);
+        ToggleByteOrder(reinterpret_cast<uchar*>(littleEndian.data()), count, entry.elementSize);
+        data = reinterpret_cast<const uchar*>(littleEndian.constData());
+        if(entry.elementSize > 1){
+            blocks[field] = littleEndian;
+        }
+#endif
+        if(compression == Compression::RLE){
+            QByteArray encoded;
+            if(EncodeRle(data, count, entry.elementSize, entry.size, encoded)){
+                entry.encoding = RLE;
+                entry.size     = encoded.size();
+                blocks[field]  = encoded;
+            }
+        }
+        entry.offset = offset;
+        offset = AlignUp(offset + entry.size);
+    }
+
+    // Offsets are relative to the start of the snapshot, so one can be embedded in a larger file.
+    const qint64 start = device.pos();
+    Header deviceHeader = header;
+    ToggleByteOrder(deviceHeader);
+    bool written = device.write(reinterpret_cast<const char*>(&deviceHeader), sizeof(deviceHeader)) == static_cast<qint64>(sizeof(deviceHeader));
+    for(int field = 0; field < FieldCount && written; ++field){
+        const FieldEntry& entry = header.fields[field];
+        const void* data = blocks[field].isEmpty() ? static_cast<const void*>(FieldData(cells, rects, field)) : blocks[field].constData();
+        written = WriteBlock(device, start + static_cast<qint64>(entry.offset), data, entry.size);
+    }
+    return written;
+}
+
+// Replaces the engine's world, seed and tick count with the snapshot at path.
+bool Snapshot::Load(const QString& path, Engine& engine, QString* error){
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)){
+        return Fail(error, path, file.errorString());
+    }
+
+    // Map the whole file. Where the file system cannot be mapped, read it instead.
+    const quint64 fileSize = static_cast<quint64>(file.size());
+    QByteArray contents;
+    const uchar* bytes = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    if(bytes == nullptr){
+        contents = file.readAll();
+        if(static_cast<quint64>(contents.size()) != fileSize){
+            return Fail(error, path, file.errorString());
+        }
+        bytes = reinterpret_cast<const uchar*>(contents.constData());
+    }
+
+    QString message;
+    if(!Read(bytes, fileSize, engine, &message)){
+        return Fail(error, path, message);
+    }
+    return true;
+}
+
+// Replaces the engine's world, seed and tick count with the snapshot in the size bytes at bytes.
+bool Snapshot::Read(const uchar* bytes, quint64 size, Engine& engine, QString* error){
+    auto Reject = [error](const QString& message){
+        if(error != nullptr){
+            *error = message;
+        }
+        return false;
+    };
+
+    if(size < sizeof(Header)){
+        return Reject("too short to be a snapshot");
+    }
+
+    Header header;
+    std::memcpy(&header, bytes, sizeof(header));
+    ToggleByteOrder(header);
+    if(std::memcmp(header.magic, Magic, sizeof(Magic)) != 0){
+        return Reject("not a snapshot");
+    }
+    if(header.version == 0 || header.version > Version){
+        return Reject(QString("unsupported snapshot version %0").arg(header.version));
+    }
+    if(header.width <= 0 || header.height <= 0 || static_cast<quint64>(header.width) * static_cast<quint64>(header.height) > MaxCells){
+        return Reject(QString("invalid world size %0x%1").arg(header.width).arg(header.height));
+    }
+
+    for(int field = 0; field < FieldCount; ++field){
+        if(!ValidBlock(field, header.fields[field], bytes, size, ElementCount(field, header.width, header.height))){
+            return Reject(QString("block %0 is corrupt").arg(field));
+        }
+    }
+
+    engine.ResizeTiles(header.width, header.height);
+    const CellGrid& cells = engine.Cells();
+    std::vector<DirtyRect> rects(engine.ChunkCount());
+    for(int field = 0; field < FieldCount; ++field){
+        DecodeBlock(header.fields[field], bytes, ElementCount(field, header.width, header.height), FieldData(cells, rects, field));
+    }
+    engine.SetSeed(header.seed);
+    engine.SetTickCount(header.tickCount);
+    engine.RebuildFromCells();
+    engine.SetPendingDirtyRects(rects);
+    return true;
+}
+
+// Returns whether the file at path starts like a snapshot.
+bool Snapshot::IsSnapshot(const QString& path){
+    QFile file(path);
+    char magic[sizeof(Magic)];
+    return file.open(QIODevice::ReadOnly)
+        && file.read(magic, sizeof(magic)) == static_cast<qint64>(sizeof(magic))
+        && std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
@@ -0,0 +1,49 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <QString>
+
+class Engine;
+class QIODevice;
+
+// Binary image of a whole world: its size, seed, tick count, every CellGrid field and which chunks are awake,
+// so a scene can be saved once and reloaded exactly, and a seeded run continued from it repeats bit for bit.
+//
+// Layout, all little-endian:
+//   Header  magic "PPESNAP\0", version, size, seed, tick count and where each block is
+//   Blocks  every CellGrid field in CellGrid order, then the chunks' pending dirty rects,
+//           each starting on a 64 byte boundary from the start of the snapshot
+// A block is stored RAW, exactly as it is held in memory, or RLE, as (quint32 run length, element) pairs.
+// Save only keeps RLE for a block when it comes out smaller, so noisy fields stay RAW and load with one memcpy.
+namespace Snapshot{
+
+    enum class Compression{
+        NONE, // Every field RAW. Largest file, fastest save and load.
+        RLE,  // Run-length encode the fields that shrink. Settled or sparse worlds shrink by orders of magnitude.
+    };
+
+    // Newest format version written by Save. Load rejects anything newer.
+    constexpr quint32 Version = 1;
+
+    // Writes the engine's world to path, replacing the file only once it is complete.
+    // Returns false and describes the problem in error if it cannot.
+    bool Save(const QString& path, const Engine& engine, Compression compression = Compression::RLE, QString* error = nullptr);
+
+    // Replaces the engine's world, seed and tick count with the snapshot at path. The file is memory-mapped and
+    // RAW fields are copied straight into the grid. The file is validated before the engine is touched,
+    // so on failure the engine is left as it was. Returns false and describes the problem in error if it cannot.
+    bool Load(const QString& path, Engine& engine, QString* error = nullptr);
+
+    // Writes a snapshot at the device's current position, for embedding one in a larger file. Returns false if
+    // the device fails; the device's own error string says why.
+    bool Write(QIODevice& device, const Engine& engine, Compression compression = Compression::RLE);
+
+    // Same as Load, but reads the snapshot from the size bytes at bytes, as written by Write.
+    bool Read(const uchar* bytes, quint64 size, Engine& engine, QString* error = nullptr);
+
+    // Returns whether the file at path starts like a snapshot, to tell it apart from a text Scenario.
+    bool IsSnapshot(const QString& path);
+
+}
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,12 @@
+#ifndef SPAN_H
+#define SPAN_H
+
+// A horizontal run of cells on row y, from left to right inclusive. Brushes are rasterized into lists of these
+// so the engine can write them a row at a time.
+struct Span{
+    int y;
+    int left;
+    int right;
+};
+
+#endif // SPAN_H
@@ -0,0 +1,122 @@
+#include "TickScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    double Milliseconds(TickScheduler::Clock::duration duration){
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+}
+
+TickScheduler::TickScheduler() :
+    m_tickRate(DefaultTickRate)
+  , m_frameBudget(DefaultFrameBudget)
+  , m_catchUp(CatchUp::SUBSTEP)
+  , m_backlog(0.0)
+  , m_regionScale(1.0)
+{
+    Reset();
+}
+
+// Target number of ticks per second.
+void TickScheduler::SetTickRate(double ticksPerSecond){
+    m_tickRate = std::max(ticksPerSecond, 0.001);
+}
+
+double TickScheduler::TickRate() const{
+    return m_tickRate;
+}
+
+// Longest a frame may keep running ticks for, in milliseconds.
+void TickScheduler::SetFrameBudget(double milliseconds){
+    m_frameBudget = std::max(milliseconds, 0.0);
+}
+
+double TickScheduler::FrameBudget() const{
+    return m_frameBudget;
+}
+
+void TickScheduler::SetCatchUp(CatchUp catchUp){
+    m_catchUp = catchUp;
+    if(m_catchUp != CatchUp::SHRINK_REGION){
+        m_regionScale = 1.0;
+    }
+}
+
+TickScheduler::CatchUp TickScheduler::CatchUpPolicy() const{
+    return m_catchUp;
+}
+
+// Starts counting from now with nothing due and the measurements cleared.
+void TickScheduler::Reset(){
+    m_lastTime    = Clock::now();
+    m_backlog     = 0.0;
+    m_regionScale = 1.0;
+    m_statistics  = Statistics();
+}
+
+// When the next tick falls due.
+TickScheduler::Clock::time_point TickScheduler::NextTick() const{
+    const double seconds = std::max(1.0 - m_backlog, 0.0) / m_tickRate;
+    return m_lastTime + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+// Runs the ticks that are due as the catch-up policy allows, calling step once per tick.
+int TickScheduler::RunFrame(const std::function<void()>& step){
+    const Clock::time_point frameStart = Clock::now();
+    m_backlog += std::chrono::duration<double>(frameStart - m_lastTime).count() * m_tickRate;
+    m_lastTime = frameStart;
+
+    const int maxTicks = m_catchUp == CatchUp::SUBSTEP ? MaxSubsteps : 1;
+    int ticks = 0;
+    while(m_backlog >= 1.0 && ticks < maxTicks){
+        // Stop before a tick that would probably run past the budget, but never before the first.
+        if(ticks > 0 && Milliseconds(Clock::now() - frameStart) + m_statistics.tickMilliseconds > m_frameBudget){
+            break;
+        }
+        const Clock::time_point tickStart = Clock::now();
+        step();
+        const double tickMilliseconds = Milliseconds(Clock::now() - tickStart);
+        m_statistics.tickMilliseconds = m_statistics.tickMilliseconds > 0.0 ? 0.9 * m_statistics.tickMilliseconds + 0.1 * tickMilliseconds
+                                                                           : tickMilliseconds;
+        m_backlog -= 1.0;
+        ++ticks;
+    }
+
+    // What is left is either caught up on by later frames or given up on. Fractions of a tick are always kept.
+    const double keep = m_catchUp == CatchUp::SUBSTEP ? std::max(MaxBacklogSeconds * m_tickRate, 1.0) : 1.0;
+    if(m_backlog > keep){
+        const double dropped = std::ceil(m_backlog - keep);
+        m_statistics.droppedTicks += static_cast<qint64>(dropped);
+        m_backlog -= dropped;
+    }
+
+    // Shrink fast while ticks overrun the tick period, grow back slowly once they take well under it.
+    if(m_catchUp == CatchUp::SHRINK_REGION && ticks > 0){
+        const double periodMilliseconds = 1000.0 / m_tickRate;
+        const double allowed = std::min(periodMilliseconds, m_frameBudget);
+        if(m_statistics.tickMilliseconds > allowed){
+            m_regionScale = std::max(m_regionScale * 0.8, MinRegionScale);
+        }else if(m_statistics.tickMilliseconds < allowed * 0.5){
+            m_regionScale = std::min(m_regionScale * 1.1, 1.0);
+        }
+    }
+
+    m_statistics.tickRate          = m_tickRate;
+    m_statistics.frameMilliseconds = Milliseconds(Clock::now() - frameStart);
+    m_statistics.backlog           = m_backlog;
+    m_statistics.frameTicks        = ticks;
+    m_statistics.regionScale       = m_regionScale;
+    return ticks;
+}
+
+// Side of the region worth updating, relative to the whole world.
+double TickScheduler::RegionScale() const{
+    return m_regionScale;
+}
+
+TickScheduler::Statistics TickScheduler::Stats() const{
+    return m_statistics;
+}
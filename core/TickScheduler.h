@@ -0,0 +1,84 @@
+#ifndef TICKSCHEDULER_H
+#define TICKSCHEDULER_H
+
+#include <QtGlobal>
+#include <chrono>
+#include <functional>
+
+// Decides when to tick so the simulation runs at a fixed rate of ticks per second, however long each tick takes.
+// Time passing adds to a backlog of due ticks; each frame runs some of them, within a time budget, and the catch-up
+// policy decides what to do when ticks take longer than the rate allows and the backlog grows.
+class TickScheduler
+{
+
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    enum class CatchUp{
+        DROP,          // One tick per frame. Ticks beyond it are dropped, so the simulation slows down but never lags.
+        SUBSTEP,       // As many ticks per frame as are due and fit in the frame budget, up to MaxSubsteps.
+                       // Up to MaxBacklogSeconds of ticks are kept to catch up on later, anything older is dropped.
+        SHRINK_REGION, // One tick per frame like DROP, and RegionScale shrinks while ticks take longer than the rate
+                       // allows and grows back once they fit, for the caller to limit the updated region by.
+    };
+
+    // Live measurements, for display.
+    struct Statistics{
+        double tickRate          = 0.0; // Target ticks per second
+        double tickMilliseconds  = 0.0; // Moving average of how long one tick takes
+        double frameMilliseconds = 0.0; // Time spent ticking in the last frame
+        double backlog           = 0.0; // Ticks due and not yet run
+        int    frameTicks        = 0;   // Ticks run in the last frame
+        qint64 droppedTicks      = 0;   // Ticks given up on since Reset
+        double regionScale       = 1.0; // See RegionScale
+    };
+
+    static constexpr double DefaultTickRate    = 1000.0 / 60.0;
+    static constexpr double DefaultFrameBudget = 33.0;
+    static constexpr int    MaxSubsteps        = 8;
+    static constexpr double MaxBacklogSeconds  = 0.25;
+    static constexpr double MinRegionScale     = 0.125;
+
+    TickScheduler();
+
+    // Target number of ticks per second.
+    void SetTickRate(double ticksPerSecond);
+
+    double TickRate() const;
+
+    // Longest a frame may keep running ticks for, in milliseconds. A frame always runs at least one tick if one is due.
+    void SetFrameBudget(double milliseconds);
+
+    double FrameBudget() const;
+
+    void SetCatchUp(CatchUp catchUp);
+
+    CatchUp CatchUpPolicy() const;
+
+    // Starts counting from now with nothing due and the measurements cleared.
+    void Reset();
+
+    // When the next tick falls due.
+    Clock::time_point NextTick() const;
+
+    // Runs the ticks that are due as the catch-up policy allows, calling step once per tick, and returns how many ran.
+    int RunFrame(const std::function<void()>& step);
+
+    // Side of the region worth updating, relative to the whole world. Always 1 unless catching up by SHRINK_REGION.
+    double RegionScale() const;
+
+    Statistics Stats() const;
+
+protected:
+
+    double m_tickRate;
+    double m_frameBudget;
+    CatchUp m_catchUp;
+    Clock::time_point m_lastTime;
+    double m_backlog;
+    double m_regionScale;
+    Statistics m_statistics;
+};
+
+#endif // TICKSCHEDULER_H
@@ -0,0 +1,36 @@
+#ifndef TILE_H
+#define TILE_H
+
+#include <QObject>
+#include <QPoint>
+#include <QDebug>
+#include "Elements.h"
+
+class Engine;
+
+// Lightweight handle to one cell of the world: where it is and what it holds.
+// Tiles are built on demand; the cell's state itself lives in the engine's CellGrid.
+struct Tile{
+
+public:
+
+    Tile() : position(-1, -1), material(Mat::Material::EMPTY){ }
+
+    Tile(int xPosIn, int yPosIn, Mat::Material materialIn) : position(xPosIn, yPosIn), material(materialIn){ }
+
+    Tile(const QPoint& positionIn, Mat::Material materialIn) : position(positionIn), material(materialIn){ }
+
+    bool operator==(const Tile& tile) const{
+        return position == tile.position
+            && material == tile.material;
+    }
+
+    bool operator!=(const Tile& tile) const{
+        return !(*this == tile);
+    }
+
+    QPoint        position;
+    Mat::Material material;
+};
+
+#endif // TILE_H
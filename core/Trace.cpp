@@ -0,0 +1,164 @@
+#include "Trace.h"
+#include <QSaveFile>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::recording(false);
+
+namespace{
+
+    struct Event{
+        const char* name;
+        qint64 begin;
+        qint64 end;
+    };
+
+    // One thread's ring. Only its own thread writes events; Save reads them after loading written.
+    struct ThreadBuffer{
+        std::unique_ptr<Event[]> events;
+        std::atomic<quint64> written{0};      // Events ever recorded; the newest is at (written - 1) % EventsPerThread
+        std::atomic<const char*> name{nullptr};
+        int id = 0;
+    };
+
+    // Buffers are kept after their thread exits, so zones of a finished thread still make it into Save.
+    // Only threads that record a zone get one.
+    std::mutex s_buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+    std::atomic<qint64> s_startTime(0);            // Trace::Now at the last Start
+    std::atomic<qint64> s_startSteadyTime(0);      // Trace::SteadyNow at the same moment, to convert Now to time
+
+    thread_local ThreadBuffer* t_buffer = nullptr;
+    thread_local const char*   t_name   = nullptr;
+
+    ThreadBuffer& OwnBuffer(){
+        if(t_buffer == nullptr){
+            std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+            buffer->events.reset(new Event[Trace::EventsPerThread]);
+            buffer->name.store(t_name, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(s_buffersMutex);
+            buffer->id = static_cast<int>(s_buffers.size()) + 1;
+            t_buffer = buffer.get();
+            s_buffers.push_back(std::move(buffer));
+        }
+        return *t_buffer;
+    }
+
+    bool Fail(QString* error, const QString& path, const QString& message){
+        if(error != nullptr){
+            *error = QString("%0: %1").arg(path).arg(message);
+        }
+        return false;
+    }
+
+}
+
+// Whether the core was built with PPE_ENABLE_TRACE.
+bool Trace::Enabled(){
+#ifdef PPE_ENABLE_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Trace::Start(){
+    s_startSteadyTime.store(SteadyNow(), std::memory_order_relaxed);
+    s_startTime.store(Now(), std::memory_order_relaxed);
+    recording.store(true, std::memory_order_relaxed);
+}
+
+void Trace::Stop(){
+    recording.store(false, std::memory_order_relaxed);
+}
+
+bool Trace::IsRecording(){
+    return recording.load(std::memory_order_relaxed);
+}
+
+void Trace::SetThreadName(const char* name){
+    t_name = name;
+    if(t_buffer != nullptr){
+        t_buffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+// Appends a finished zone to the calling thread's ring.
+void Trace::Record(const char* name, qint64 begin, qint64 end){
+    ThreadBuffer& buffer = OwnBuffer();
+    const quint64 written = buffer.written.load(std::memory_order_relaxed);
+    buffer.events[written % EventsPerThread] = { name, begin, end };
+    buffer.written.store(written + 1, std::memory_order_release);
+}
+
+// Writes every zone recorded since the last Start as Chrome trace event JSON: a thread_name metadata event per
+// thread, then one complete ("X") event per zone with its start and duration in microseconds.
+bool Trace::Save(const QString& path, QString* error){
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)){
+        return Fail(error, path, file.errorString());
+    }
+
+    // Timestamps go out in microseconds. The time stamp counter's rate is measured over the time since Start.
+    const qint64 startTime = s_startTime.load(std::memory_order_relaxed);
+#ifdef PPE_TRACE_TSC
+    const double elapsedNanoseconds = static_cast<double>(SteadyNow() - s_startSteadyTime.load(std::memory_order_relaxed));
+    const double elapsedTicks       = static_cast<double>(Now() - startTime);
+    const double ticksPerMicrosecond = elapsedNanoseconds > 0.0 && elapsedTicks > 0.0 ? elapsedTicks / elapsedNanoseconds * 1e3 : 1e3;
+#else
+    const double ticksPerMicrosecond = 1e3;
+#endif
+    std::vector<Event> events;
+    QByteArray json("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    auto Append = [&](const QByteArray& event){
+        if(!first){
+            json += ",\n";
+        }
+        first = false;
+        json += event;
+    };
+
+    std::lock_guard<std::mutex> lock(s_buffersMutex);
+    for(const std::unique_ptr<ThreadBuffer>& buffer : s_buffers){
+        const char* name = buffer->name.load(std::memory_order_relaxed);
+        const QByteArray threadName = name != nullptr ? QByteArray(name) : "Thread " + QByteArray::number(buffer->id);
+        Append("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + QByteArray::number(buffer->id)
+               + ",\"args\":{\"name\":\"" + threadName + "\"}}");
+
+        // The thread may still be recording: copy the ring, then drop the oldest events it overwrote during the copy,
+        // counting the one it may be halfway through writing.
+        const qint64 written = static_cast<qint64>(buffer->written.load(std::memory_order_acquire));
+        const qint64 kept = std::min<qint64>(written, EventsPerThread);
+        events.assign(kept, Event());
+        for(qint64 i = 0; i < kept; ++i){
+            events[i] = buffer->events[( written - kept + i ) % EventsPerThread];
+        }
+        const qint64 writing = static_cast<qint64>(buffer->written.load(std::memory_order_acquire));
+        const qint64 overwritten = qBound<qint64>(0, writing + 1 - EventsPerThread - ( written - kept ), kept);
+
+        for(qint64 i = overwritten; i < kept; ++i){
+            const Event& event = events[i];
+            if(event.begin < startTime){
+                continue;
+            }
+            Append("{\"ph\":\"X\",\"name\":\"" + QByteArray(event.name) + "\",\"pid\":1,\"tid\":" + QByteArray::number(buffer->id)
+                   + ",\"ts\":" + QByteArray::number(( event.begin - startTime ) / ticksPerMicrosecond, 'f', 3)
+                   + ",\"dur\":" + QByteArray::number(( event.end - event.begin ) / ticksPerMicrosecond, 'f', 3) + "}");
+            if(json.size() > ( 1 << 20 )){
+                if(file.write(json) != json.size()){
+                    return Fail(error, path, file.errorString());
+                }
+                json.clear();
+            }
+        }
+    }
+    json += "\n]}\n";
+
+    if(file.write(json) != json.size() || !file.commit()){
+        return Fail(error, path, file.errorString());
+    }
+    return true;
+}
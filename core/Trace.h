@@ -0,0 +1,103 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define PPE_TRACE_TSC
+#endif
+
+// Timeline of scoped zones on every thread, for seeing how ticks, paints and input interleave and stall each other.
+// Zones only exist in code built with PPE_ENABLE_TRACE defined (qmake CONFIG+=trace); otherwise every
+// PPE_TRACE_ZONE compiles to nothing. While recording, each thread appends the zones it finishes to a ring of
+// its own without taking a lock; Save writes the rings out as Chrome trace event JSON, which Perfetto and
+// chrome://tracing open.
+namespace Trace{
+
+    // Zones each thread keeps. Once a thread's ring is full its oldest zones are overwritten.
+    constexpr int EventsPerThread = 1 << 16;
+
+    // Whether the core was built with PPE_ENABLE_TRACE.
+    bool Enabled();
+
+    // Starts recording zones. Zones finished before this are left out of Save.
+    void Start();
+
+    // Stops recording zones. Zones already open still finish and are kept.
+    void Stop();
+
+    bool IsRecording();
+
+    // Names the calling thread in saved traces. name must be a string literal, or otherwise outlive every Save.
+    void SetThreadName(const char* name);
+
+    // Writes the zones of every thread recorded since the last Start to path as Chrome trace event JSON.
+    // Returns false and describes the problem in error if it cannot.
+    bool Save(const QString& path, QString* error = nullptr);
+
+    // Nanoseconds on steady_clock.
+    inline qint64 SteadyNow(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Timestamp zones are timed with: the CPU's time stamp counter where there is one, which takes a fraction of
+    // the time steady_clock does to read, otherwise SteadyNow. Save converts either to microseconds.
+    inline qint64 Now(){
+#ifdef PPE_TRACE_TSC
+        return static_cast<qint64>(__rdtsc());
+#else
+        return SteadyNow();
+#endif
+    }
+
+    // Appends a finished zone to the calling thread's ring. name must be a string literal without quotes or backslashes.
+    void Record(const char* name, qint64 begin, qint64 end);
+
+    extern std::atomic<bool> recording;
+
+    // Times its own lifetime as a zone named name, if recording when it is created. Use through PPE_TRACE_ZONE.
+    class Zone{
+
+    public:
+
+        explicit Zone(const char* name) :
+            m_name(name)
+          , m_begin(recording.load(std::memory_order_relaxed) ? Now() : -1)
+        {
+        }
+
+        ~Zone(){
+            if(m_begin >= 0){
+                Record(m_name, m_begin, Now());
+            }
+        }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    protected:
+
+        const char* m_name;
+        qint64 m_begin; // -1 when not recording
+    };
+
+}
+
+// Times the rest of the enclosing scope as a zone named name, a string literal. Nothing without PPE_ENABLE_TRACE.
+#ifdef PPE_ENABLE_TRACE
+#define PPE_TRACE_CONCAT_(a, b) a##b
+#define PPE_TRACE_CONCAT(a, b) PPE_TRACE_CONCAT_(a, b)
+#define PPE_TRACE_ZONE(name) const Trace::Zone PPE_TRACE_CONCAT(traceZone, __LINE__)(name)
+#else
+#define PPE_TRACE_ZONE(name) static_cast<void>(0)
+#endif
+
+#endif // TRACE_H
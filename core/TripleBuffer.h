@@ -0,0 +1,71 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Hands values from one producer thread to one consumer thread without either of them ever waiting on the other.
+// Of the three slots the producer owns one to write into, the consumer one to read from, and the third holds the
+// newest published value. Publishing and taking each swap the caller's slot with that third one in a single atomic
+// exchange, so the consumer always gets the latest value and skips any it was too slow for.
+template<typename T>
+class TripleBuffer
+{
+
+public:
+
+    TripleBuffer() :
+        m_back(0)
+      , m_middle(1)
+      , m_front(2)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer side. The slot to write the next value into; it keeps whatever was last written into it.
+    T& Back(){
+        return m_slots[m_back];
+    }
+
+    // Producer side. Which of the three slots Back is, for producers that track something per slot.
+    int BackIndex() const{
+        return m_back;
+    }
+
+    // Producer side. Makes Back the newest value and hands the producer another slot. Returns whether the consumer
+    // had taken the value published before, so the one it holds now is no older than that.
+    bool Publish(){
+        const int previous = m_middle.exchange(m_back | Fresh, std::memory_order_acq_rel);
+        m_back = previous & IndexMask;
+        return ( previous & Fresh ) == 0;
+    }
+
+    // Consumer side. Moves Front to the newest value if one was published since the last call, and returns whether it did.
+    bool Take(){
+        if(( m_middle.load(std::memory_order_acquire) & Fresh ) == 0){
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & IndexMask;
+        return true;
+    }
+
+    // Consumer side. The value taken last. The producer will not touch it until the next Take.
+    const T& Front() const{
+        return m_slots[m_front];
+    }
+
+protected:
+
+    // m_middle holds a slot index, plus Fresh while the slot holds a value the consumer has not taken.
+    static constexpr int IndexMask = 3;
+    static constexpr int Fresh     = 4;
+
+    T m_slots[3];
+    int m_back;
+    std::atomic<int> m_middle;
+    int m_front;
+
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,27 @@
+#ifndef UPDATECONTEXT_H
+#define UPDATECONTEXT_H
+
+#include "Counters.h"
+#include "Random.h"
+#include <QRect>
+
+class Engine;
+
+// State handed to the update kernels for the region currently being updated.
+// When chunks update in parallel every chunk gets its own context.
+struct UpdateContext{
+
+    UpdateContext(Engine* engineIn, const QRect& reachIn, const Random& randomIn) :
+        engine(engineIn)
+      , reach(reachIn)
+      , random(randomIn) { }
+
+    Engine* engine;
+    QRect   reach;  // Cells this update may touch. Long range moves are clamped to it.
+    Random  random; // This update's own stream, see Engine::SetSeed
+#ifdef PPE_ENABLE_COUNTERS
+    ChunkCounters counters; // Added to the engine's totals by Engine::UpdateChunk, see PPE_COUNT
+#endif
+};
+
+#endif // UPDATECONTEXT_H
@@ -0,0 +1,114 @@
+#include "WorkerPool.h"
+#include "Trace.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threadCount) :
+    m_task(nullptr)
+  , m_nextTask(0)
+  , m_taskCount(0)
+  , m_busyWorkers(0)
+  , m_generation(0)
+  , m_stopping(false)
+{
+    SetThreadCount(threadCount);
+}
+
+WorkerPool::~WorkerPool(){
+    StopWorkers();
+}
+
+// Stops the current workers and starts threadCount - 1 new ones. Values below 1 are treated as 1.
+void WorkerPool::SetThreadCount(int threadCount){
+    threadCount = std::max(threadCount, 1);
+    if(threadCount == ThreadCount()){
+        return;
+    }
+    StopWorkers();
+    StartWorkers(threadCount - 1);
+}
+
+// Number of threads that take part in Run, including the caller.
+int WorkerPool::ThreadCount() const{
+    return static_cast<int>(m_workers.size()) + 1;
+}
+
+// Calls task(i) for every i in [0, taskCount) spread across the pool and returns once all of them finished.
+void WorkerPool::Run(int taskCount, const std::function<void(int)>& task){
+    if(taskCount <= 0){
+        return;
+    }
+
+    // Not worth waking anyone for.
+    if(m_workers.empty() || taskCount == 1){
+        for(int i = 0; i < taskCount; ++i){
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task        = &task;
+        m_taskCount   = taskCount;
+        m_busyWorkers = static_cast<int>(m_workers.size());
+        m_nextTask.store(0, std::memory_order_relaxed);
+        ++m_generation;
+    }
+    m_wakeCondition.notify_all();
+
+    Drain();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this](){ return m_busyWorkers == 0; });
+    m_task = nullptr;
+}
+
+void WorkerPool::StartWorkers(int workerCount){
+    m_stopping = false;
+    m_workers.reserve(workerCount);
+    // Workers start from the generation current now, not whenever their thread gets going,
+    // otherwise a Run issued before a new thread first takes the lock would count it as busy and never see it finish.
+    for(int i = 0; i < workerCount; ++i){
+        m_workers.emplace_back(&WorkerPool::WorkerLoop, this, m_generation);
+    }
+}
+
+void WorkerPool::StopWorkers(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+    for(std::thread& worker : m_workers){
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void WorkerPool::WorkerLoop(unsigned long long seenGeneration){
+    Trace::SetThreadName("Worker");
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [this, seenGeneration](){ return m_stopping || m_generation != seenGeneration; });
+            if(m_stopping){
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        Drain();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(--m_busyWorkers == 0){
+            m_doneCondition.notify_one();
+        }
+    }
+}
+
+// Claims and runs tasks from the current batch until none are left.
+void WorkerPool::Drain(){
+    for(int i = m_nextTask.fetch_add(1, std::memory_order_relaxed); i < m_taskCount; i = m_nextTask.fetch_add(1, std::memory_order_relaxed)){
+        (*m_task)(i);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent set of threads that run batches of independent tasks.
+// The thread calling Run always takes part, so a pool of N threads owns N - 1 workers.
+class WorkerPool
+{
+
+public:
+
+    explicit WorkerPool(int threadCount = 1);
+
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Stops the current workers and starts threadCount - 1 new ones. Values below 1 are treated as 1.
+    void SetThreadCount(int threadCount);
+
+    // Number of threads that take part in Run, including the caller.
+    int ThreadCount() const;
+
+    // Calls task(i) for every i in [0, taskCount) spread across the pool and returns once all of them finished.
+    void Run(int taskCount, const std::function<void(int)>& task);
+
+protected:
+
+    void StartWorkers(int workerCount);
+
+    void StopWorkers();
+
+    void WorkerLoop(unsigned long long seenGeneration);
+
+    // Claims and runs tasks from the current batch until none are left.
+    void Drain();
+
+protected:
+
+    std::vector<std::thread>        m_workers;
+    std::mutex                      m_mutex;
+    std::condition_variable         m_wakeCondition;
+    std::condition_variable         m_doneCondition;
+    const std::function<void(int)>* m_task;
+    std::atomic<int>                m_nextTask;
+    int                             m_taskCount;
+    int                             m_busyWorkers;
+    unsigned long long              m_generation;
+    bool                            m_stopping;
+
+};
+
+#endif // WORKERPOOL_H
@@ -0,0 +1,17 @@
+# Include from any project that links against the core simulation library.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+
+# Trace zones are also placed outside the core, see Trace.h.
+trace: DEFINES += PPE_ENABLE_TRACE
+
+win32:CONFIG(release, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/release
+else:win32:CONFIG(debug, debug|release): CORE_LIB_DIR = $$OUT_PWD/../core/debug
+else: CORE_LIB_DIR = $$OUT_PWD/../core
+
+LIBS += -L$$CORE_LIB_DIR -lPixelPhysicsCore
+
+win32-g++: PRE_TARGETDEPS += $$CORE_LIB_DIR/libPixelPhysicsCore.a
+else:win32: PRE_TARGETDEPS += $$CORE_LIB_DIR/PixelPhysicsCore.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libPixelPhysicsCore.a
@@ -0,0 +1,53 @@
+QT       = core
+
+TEMPLATE = lib
+CONFIG  += staticlib c++17
+TARGET   = PixelPhysicsCore
+
+QMAKE_CXXFLAGS += -Wall -Wextra -pedantic -Wshadow
+
+# qmake CONFIG+=counters builds in the per tick instrumentation of Counters.h.
+counters: DEFINES += PPE_ENABLE_COUNTERS
+# qmake CONFIG+=trace builds in the timeline zones of Trace.h. core.pri passes it on to the projects using the core.
+trace: DEFINES += PPE_ENABLE_TRACE
+
+SOURCES += \
+    Brush.cpp \
+    CellGrid.cpp \
+    Counters.cpp \
+    Elements.cpp \
+    Engine.cpp \
+    Heat.cpp \
+    Occupancy.cpp \
+    Recording.cpp \
+    RowKernels.cpp \
+    Scenario.cpp \
+    SimulationThread.cpp \
+    Snapshot.cpp \
+    TickScheduler.cpp \
+    Trace.cpp \
+    WorkerPool.cpp
+
+HEADERS += \
+    Brush.h \
+    CellGrid.h \
+    Chunk.h \
+    Counters.h \
+    Elements.h \
+    Engine.h \
+    Fire.h \
+    Hashhelpers.h \
+    Heat.h \
+    Occupancy.h \
+    Random.h \
+    Recording.h \
+    Scenario.h \
+    SimulationThread.h \
+    Snapshot.h \
+    Span.h \
+    TickScheduler.h \
+    Tile.h \
+    Trace.h \
+    TripleBuffer.h \
+    UpdateContext.h \
+    WorkerPool.h